@@ -94,46 +94,27 @@ void DocTreeViewItem::paintItem (Graphics& g, int width, int height)
 //=================================================================================================
 const File DocTreeViewItem::getMdFileOrDir (const ValueTree& tree)
 {
-    if (!tree.isValid())
-        return File::nonexistent;
-
-    const File& root (FileTreeContainer::projectFile.getSiblingFile ("docs"));
-
-    if (tree.getType().toString() == "wdtpProject")
-    {
-        return root;
-    }
-    else
-    {
-        String path = tree.getProperty ("name").toString();
-        ValueTree t (tree);
-
-        while (t.getParent().isValid() && t.getParent().getType().toString() != "wdtpProject")
-        {
-            t = t.getParent();
-            path = t.getProperty ("name").toString() + File::separator + path;
-        }
-
-        if (tree.getType().toString() == "doc")
-            path += ".md";
-
-        return root.getChildFile (path);
-    }
+    return ProjectNodeTable::getMdFileOrDir (tree);
 }
 
 //=================================================================================================
 const File DocTreeViewItem::getHtmlFileOrDir (const File& mdFileOrDir)
 {
+    const File siteFileOrDir (ProjectNodeTable::getSiteFileOrDir (mdFileOrDir));
+
+    if (siteFileOrDir == File::nonexistent)
+        return File::nonexistent;
+
     if (mdFileOrDir.isDirectory())
-        return File (mdFileOrDir.getFullPathName().replace ("docs", "site")).getChildFile ("index.html");
+        return siteFileOrDir.getChildFile ("index.html");
     else
-        return File (mdFileOrDir.getFullPathName().replace ("docs", "site")).withFileExtension ("html");
+        return siteFileOrDir.withFileExtension ("html");
 }
 
 //=================================================================================================
 const File DocTreeViewItem::getHtmlFileOrDir (const ValueTree& tree)
 {
-    return getHtmlFileOrDir (getMdFileOrDir (tree));
+    return ProjectNodeTable::getHtmlFile (tree);
 }
 
 //=================================================================================================
@@ -561,22 +542,26 @@ void DocTreeViewItem::renameSelectedItem()
             needCreate (tree.getType().toString() == "doc" ? tree : FileTreeContainer::projectTree);
 
             // rename the site dir or html-file
-            File siteOldFile;
+            File siteOldFile (ProjectNodeTable::getSiteFileOrDir (docFileOrDir));
             File siteNewFile;
 
-            if (newDocFile.isDirectory())
+            if (siteOldFile != File::nonexistent)
             {
-                siteOldFile = File (docFileOrDir.getFullPathName().replace ("docs", "site"));
-                siteNewFile = File (siteOldFile.getSiblingFile (newName)).getNonexistentSibling (true);
-            }
-            else
-            {
-                siteOldFile = File (docFileOrDir.getFullPathName().replace ("docs", "site")).withFileExtension ("html");
-                siteNewFile = File (siteOldFile.getSiblingFile (newName + ".html")).getNonexistentSibling (true);
-            }
+                if (newDocFile.isDirectory())
+                {
+                    siteNewFile = File (siteOldFile.getSiblingFile (newName)).getNonexistentSibling (true);
+                }
+                else
+                {
+                    siteOldFile = siteOldFile.withFileExtension ("html");
+                    siteNewFile = File (siteOldFile.getSiblingFile (newName + ".html")).getNonexistentSibling (true);
+                }
 
-            if (siteOldFile.exists())
-                siteOldFile.moveFileTo (siteNewFile);
+                GzipProcessor::deleteGzipFiles (siteOldFile);
+
+                if (siteOldFile.exists())
+                    siteOldFile.moveFileTo (siteNewFile);
+            }
 
             // here must re-select this item
             setSelected (false, false, dontSendNotification);
@@ -639,18 +624,30 @@ void DocTreeViewItem::exportAsHtml()
             + descStr + newLine + newLine
             + "[TOC]" + newLine + newLine + mdFile.loadFileAsString();
 
-        htmlFile.appendText ("<!doctype html>\n"
-                             "<html lang = \"en\">\n"
-                             "<head>\n"
-                             "<meta charset = \"UTF-8\">\n"
-                             "  <link rel = \"stylesheet\" type = \"text/css\" href = \"media/style.css\"/>\n"
-                             "  <script src = \"media/hl.js\"></script>\n"
-                             "  <script>hljs.initHighlightingOnLoad(); </script>\n"
-                             "<title>" + titleStr + "</title>\n"
-                             "</head>\n"
-                             "<body>\n\n" + Md2Html::mdStringToHtml (contentStr) + "\n\n"
-                             "</body>\n"
-                             "</html>");
+        // the html of the whole dir could be huge, it's written straight into the file
+        ScopedPointer<FileOutputStream> out = htmlFile.createOutputStream();
+
+        if (out != nullptr)
+        {
+            out->writeText ("<!doctype html>\n"
+                            "<html lang = \"en\">\n"
+                            "<head>\n"
+                            "<meta charset = \"UTF-8\">\n"
+                            "  <link rel = \"stylesheet\" type = \"text/css\" href = \"media/style.css\"/>\n"
+                            "  <script src = \"media/hl.js\"></script>\n"
+                            "  <script>hljs.initHighlightingOnLoad(); </script>\n"
+                            "<title>" + titleStr + "</title>\n"
+                            "</head>\n"
+                            "<body>\n\n", false, false);
+
+            Md2Html::mdStringToHtml (contentStr, *out);
+
+            out->writeText ("\n\n"
+                            "</body>\n"
+                            "</html>", false, false);
+            out->flush();
+            out = nullptr;
+        }
 
         // create its media folder and copy all medias into it
         const File mediaDir (htmlFile.getSiblingFile ("media"));
@@ -860,7 +857,13 @@ void DocTreeViewItem::deleteSelected()
 
                 // delete the two-files
                 mdFile.moveToTrash();
-                siteFile.deleteRecursively();
+
+                if (siteFile != File::nonexistent)
+                {
+                    GzipProcessor::deleteGzipFiles (siteFile);
+                    siteFile.deleteRecursively();
+                }
+
                 v.getParent().removeChild (v, nullptr);
             }
         }
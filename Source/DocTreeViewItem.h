@@ -28,7 +28,8 @@ public:
     Note 2: this method will return a nonexists file when the arg is invalid. */
     static const File getMdFileOrDir (const ValueTree& tree);
 
-    /** these two methods will return index.html when it's a dir. */
+    /** these two methods will return index.html when it's a dir,
+        a nonexistent file when the md file or dir isn't in "docs". */
     static const File getHtmlFileOrDir (const File& mdFileOrDir);
     static const File getHtmlFileOrDir (const ValueTree& tree);
 
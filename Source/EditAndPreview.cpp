@@ -156,7 +156,7 @@ void EditAndPreview::previewCurrentDoc()
         const bool itNeedsCreate = (bool)docOrDirTree.getProperty ("needCreateHtml");
 
         const String urlStr ((docOrDirFile.existsAsFile()) ?
-                             HtmlProcessor::createArticleHtml (docOrDirTree, true).getFullPathName() :
+                             HtmlProcessor::createArticleHtml (docOrDirTree, true, &previewCache).getFullPathName() :
                              HtmlProcessor::createIndexHtml (docOrDirTree, true).getFullPathName());
 
         // prevent load it every time when preview a non-changed and the same web-page.
@@ -210,6 +210,7 @@ void EditAndPreview::projectClosed()
     docOrDirTree = ValueTree::invalid;
     docHasChanged = false;
     currentContent.clear();
+    previewCache.clear();
 
     resized();
 }
@@ -68,6 +68,9 @@ private:
     bool docHasChanged;
     String currentContent, currentUrl;
 
+    // the preview of the doc which is being edited only parses its changed blocks
+    Md2Html::BlockCache previewCache;
+
     MainContentComponent* mainComp;
 
     ScopedPointer<TextEditor> editor;
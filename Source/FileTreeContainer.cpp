@@ -15,6 +15,138 @@ extern PropertiesFile* systemFile;
 File FileTreeContainer::projectFile;
 ValueTree FileTreeContainer::projectTree = ValueTree::invalid;
 
+//==============================================================================
+class FileTreeContainer::ProjectListener  : private ValueTree::Listener
+{
+public:
+    ProjectListener()
+    {
+        // it moves to the new project tree whenever projectTree is assigned
+        projectTree.addListener (this);
+    }
+
+    ~ProjectListener()
+    {
+        projectTree.removeListener (this);
+    }
+
+    void addCache (ProjectCache* cache)
+    {
+        const ScopedLock sl (lock);
+        caches.add (cache);
+    }
+
+    void removeCache (ProjectCache* cache)
+    {
+        const ScopedLock sl (lock);
+        caches.removeFirstMatchingValue (cache);
+    }
+
+    void projectChanged()
+    {
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->projectChanged();
+    }
+
+    void applyToProject()
+    {
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->applyToProject();
+    }
+
+private:
+    /** a cache could be made (and added) while the others are being told */
+    const Array<ProjectCache*> getCaches() const
+    {
+        const ScopedLock sl (lock);
+        return caches;
+    }
+
+    //=========================================================================
+    void valueTreePropertyChanged (ValueTree& tree, const Identifier& property) override
+    {
+        // changed for each page while generating, none of the caches is made from it
+        if (property == Identifier ("needCreateHtml"))
+            return;
+
+        // stamped by ProjectNodeTable itself
+        if (property == Identifier ("nodeTableRow"))
+            return;
+
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->propertyChanged (tree, property);
+    }
+
+    void valueTreeChildAdded (ValueTree& parentTree, ValueTree& child) override
+    {
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->treeAdded (parentTree, child);
+    }
+
+    void valueTreeChildRemoved (ValueTree& parentTree, ValueTree& child, int) override
+    {
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->treeRemoved (parentTree, child);
+    }
+
+    void valueTreeChildOrderChanged (ValueTree& parentTree, int, int) override
+    {
+        const Array<ProjectCache*> cachesNow (getCaches());
+
+        for (int i = 0; i < cachesNow.size(); ++i)
+            cachesNow.getUnchecked (i)->childrenReordered (parentTree);
+    }
+
+    void valueTreeParentChanged (ValueTree&) override       { }
+
+    // projectFile is still the last one here, see FileTreeContainer::projectChanged()
+    void valueTreeRedirected (ValueTree&) override          { }
+
+    //=========================================================================
+    Array<ProjectCache*> caches;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (ProjectListener)
+};
+
+//==============================================================================
+FileTreeContainer::ProjectListener& FileTreeContainer::getProjectListener()
+{
+    static ProjectListener listener;
+    return listener;
+}
+
+void FileTreeContainer::projectChanged()
+{
+    getProjectListener().projectChanged();
+}
+
+void FileTreeContainer::applyProjectCaches()
+{
+    getProjectListener().applyToProject();
+}
+
+//==============================================================================
+ProjectCache::ProjectCache()
+{
+    FileTreeContainer::getProjectListener().addCache (this);
+}
+
+ProjectCache::~ProjectCache()
+{
+    FileTreeContainer::getProjectListener().removeCache (this);
+}
+
 //==============================================================================
 FileTreeContainer::FileTreeContainer (EditAndPreview* rightArea) :
     editAndPreview (rightArea)
@@ -119,6 +251,8 @@ void FileTreeContainer::openProject (const File& project)
 
     // load the project
     projectFile = realProject;
+    projectChanged();
+    HtmlProcessor::indexDocsOfProject();
     sorter = new ItemSorter (projectTree);
     docTreeItem = new DocTreeViewItem (projectTree, this, sorter);
     sorter->setTreeViewItem (docTreeItem);
@@ -177,6 +311,7 @@ void FileTreeContainer::closeProject()
             sorter = nullptr;
             projectTree = ValueTree::invalid;
             projectFile = File::nonexistent;
+            projectChanged();
             editAndPreview->projectClosed();
 
             // change the text of main window's title-bar           
@@ -368,12 +503,15 @@ void FileTreeContainer::reloadCurrentDoc()
 //=================================================================================================
 bool FileTreeContainer::saveProject()
 {
+    applyProjectCaches();
+
     if (!SwingUtilities::writeValueTreeToFile (projectTree, projectFile, true))
     {
         SHOW_MESSAGE (TRANS ("Something wrong during saving this project."));
         return false;
     }
 
+    MediaProcessor::finishImages();
     return true;
 }
 
@@ -14,6 +14,44 @@
 class FileTreeContainer;
 class DocTreeViewItem;
 
+//=========================================================================
+/** A cache which is made from the project (the site menu, the indexes of the docs...).
+    All of them are told about the changes of the project by the one listener of the
+    project tree, see FileTreeContainer::ProjectListener.
+
+    The callbacks come from inside the callbacks of the project tree, so a cache only changes
+    itself there. Whatever it has to change in the project (e.g. the pages which should be
+    generated again) waits for applyToProject().
+*/
+class ProjectCache
+{
+public:
+    ProjectCache();
+    virtual ~ProjectCache();
+
+    /** another project has been opened (or the project has been closed), forget everything */
+    virtual void projectChanged() = 0;
+
+    /** a doc or dir (with the docs and dirs in it) has been added to the parent */
+    virtual void treeAdded (const ValueTree& /*parentTree*/, const ValueTree& /*tree*/)          { }
+
+    /** a doc or dir (with the docs and dirs in it) has been removed from the parent */
+    virtual void treeRemoved (const ValueTree& /*parentTree*/, const ValueTree& /*tree*/)        { }
+
+    /** a property of the project, a doc or a dir has been changed */
+    virtual void propertyChanged (const ValueTree& /*tree*/, const Identifier& /*property*/)     { }
+
+    /** the docs and dirs in the parent have been reordered */
+    virtual void childrenReordered (const ValueTree& /*parentTree*/)                            { }
+
+    /** change the project for what the callbacks have seen. It's called before the project
+        is saved and before the pages are generated. */
+    virtual void applyToProject()                                                               { }
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (ProjectCache)
+};
+
 //=========================================================================
 /** For sort items of class DocTreeViewItem.
     Usage: create object, then call setTreeViewItem().
@@ -83,12 +121,23 @@ public:
     static bool saveProject();
     const bool selectItemFromHtmlFile (const File& html);
 
+    /** let the caches of the project change it (see ProjectCache::applyToProject()) */
+    static void applyProjectCaches();
+
     // 2 core static objects. this's a BAD design I totally know that but it's handy :)
     static File projectFile;
     static ValueTree projectTree;
 
 private:
     //=========================================================================
+    /** the one listener of the project tree, it tells all the ProjectCaches */
+    class ProjectListener;
+    static ProjectListener& getProjectListener();
+    friend class ProjectCache;
+
+    /** after both projectTree and projectFile have been set */
+    static void projectChanged();
+
     ScopedPointer<DocTreeViewItem> docTreeItem;
     ScopedPointer<ItemSorter> sorter;
 
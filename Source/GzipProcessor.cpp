@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    GzipProcessor.cpp
+    Created: 16 Oct 2026 6:07:30pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "WdtpHeader.h"
+
+/** the copies which are written by updateSite(), the other .gz files of the site aren't touched */
+static const char* const gzipCopyPatterns = "*.html.gz;*.css.gz;*.js.gz";
+
+//=================================================================================================
+class GzipProcessor::CompressJob : public ThreadPoolJob
+{
+public:
+    CompressJob (const File& siteFile_)
+        : ThreadPoolJob ("Gzip copy"),
+          siteFile (siteFile_)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        const File gzipFile (getGzipFile (siteFile));
+        MemoryBlock content;
+
+        if (!siteFile.loadFileAsData (content))
+            return jobHasFinished;
+
+        // the file has been written again but it's the same as before (e.g. the whole site
+        // has been regenerated), only let the copy be newer than it
+        if (gzipFile.existsAsFile() && isCopyOf (gzipFile, content))
+        {
+            gzipFile.setLastModificationTime (Time::getCurrentTime());
+            return jobHasFinished;
+        }
+
+        TemporaryFile tempFile (gzipFile);
+        ScopedPointer<FileOutputStream> out (tempFile.getFile().createOutputStream());
+
+        if (out == nullptr)
+            return jobHasFinished;
+
+        bool written = false;
+
+        {
+            // 15 + 16 window-bits: the gzip format (header and crc) rather than zlib's
+            GZIPCompressorOutputStream gzip (out, 9, false, 15 + 16);
+            written = gzip.write (content.getData(), content.getSize());
+            gzip.flush();
+        }
+
+        // the end of the deflate stream is only written by the flush(), a copy which couldn't
+        // be written completely (e.g. the disk is full) mustn't replace the good one
+        out->flush();
+        written = written && out->getStatus().wasOk();
+        out = nullptr;
+
+        if (written)
+            tempFile.overwriteTargetFileWithTemporary();
+
+        return jobHasFinished;
+    }
+
+private:
+    const File siteFile;
+
+    JUCE_DECLARE_NON_COPYABLE (CompressJob)
+};
+
+//=================================================================================================
+ThreadPool& GzipProcessor::getCompressPool()
+{
+    static ThreadPool pool (jmax (1, SystemStats::getNumCpus() - 1));
+    return pool;
+}
+
+//=================================================================================================
+void GzipProcessor::updateSite()
+{
+    const bool gzipThem = (bool)FileTreeContainer::projectTree.getProperty ("gzip");
+    const File siteDir (FileTreeContainer::projectFile.getSiblingFile ("site"));
+
+    // the copies whose file has gone
+    Array<File> gzipFiles;
+    siteDir.findChildFiles (gzipFiles, File::findFiles, true, gzipCopyPatterns);
+
+    for (int i = gzipFiles.size(); --i >= 0; )
+    {
+        const File& gzipFile (gzipFiles.getReference (i));
+
+        if (!gzipThem || !gzipFile.getSiblingFile (gzipFile.getFileNameWithoutExtension()).existsAsFile())
+            gzipFile.deleteFile();
+    }
+
+    if (!gzipThem)
+        return;
+
+    Array<File> siteFiles;
+    siteDir.findChildFiles (siteFiles, File::findFiles, true, "*.html");
+    siteDir.getChildFile ("add-in").findChildFiles (siteFiles, File::findFiles, false, "*.css;*.js");
+
+    ThreadPool& pool (getCompressPool());
+    OwnedArray<CompressJob> jobs;
+
+    for (int i = 0; i < siteFiles.size(); ++i)
+    {
+        const File& siteFile (siteFiles.getReference (i));
+        const File gzipFile (getGzipFile (siteFile));
+
+        // a copy which is newer than its file and was written from the same size of it is
+        // still right. the same time isn't enough: a file system could keep them in seconds
+        if (gzipFile.existsAsFile()
+            && gzipFile.getLastModificationTime() > siteFile.getLastModificationTime()
+            && getOriginalSize (gzipFile) == (siteFile.getSize() & 0xffffffff))
+            continue;
+
+        pool.addJob (jobs.add (new CompressJob (siteFile)), false);
+    }
+
+    for (int i = 0; i < jobs.size(); ++i)
+        pool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+}
+
+//=================================================================================================
+const File GzipProcessor::getGzipFile (const File& siteFile)
+{
+    return siteFile.getSiblingFile (siteFile.getFileName() + ".gz");
+}
+
+//=================================================================================================
+void GzipProcessor::deleteGzipFiles (const File& siteFileOrDir)
+{
+    if (siteFileOrDir.isDirectory())
+    {
+        Array<File> gzipFiles;
+        siteFileOrDir.findChildFiles (gzipFiles, File::findFiles, true, gzipCopyPatterns);
+
+        for (int i = gzipFiles.size(); --i >= 0; )
+            gzipFiles.getReference (i).deleteFile();
+    }
+    else
+    {
+        getGzipFile (siteFileOrDir).deleteFile();
+    }
+}
+
+//=================================================================================================
+const int64 GzipProcessor::getOriginalSize (const File& gzipFile)
+{
+    FileInputStream in (gzipFile);
+
+    if (in.failedToOpen() || in.getTotalLength() < 4 || !in.setPosition (in.getTotalLength() - 4))
+        return -1;
+
+    // the last 4 bytes of a gzip, little-endian
+    return (int64) (uint32) in.readInt();
+}
+
+//=================================================================================================
+const bool GzipProcessor::isCopyOf (const File& gzipFile, const MemoryBlock& content)
+{
+    GZIPDecompressorInputStream gzip (new FileInputStream (gzipFile), true,
+                                      GZIPDecompressorInputStream::gzipFormat);
+    MemoryBlock original;
+    gzip.readIntoMemoryBlock (original);
+
+    return original == content;
+}
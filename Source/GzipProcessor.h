@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    GzipProcessor.h
+    Created: 16 Oct 2026 6:07:30pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef GZIPPROCESSOR_H_INCLUDED
+#define GZIPPROCESSOR_H_INCLUDED
+
+/** The precompressed copies beside the files of the site ("xxx.html.gz", "add-in/style.css.gz"),
+    which could be sent by the web server directly (e.g. the "gzip_static" of nginx) */
+struct GzipProcessor
+{
+    /** When the "gzip" of the project is on, write the .gz copy of each html in the site and
+        each css and js in "site/add-in" on the worker threads, and wait for them. A copy is
+        only rewritten when the content of its file has been changed.
+
+        The copies whose file has gone are removed, or all the copies when the "gzip" is off.
+        It'll be called after the htmls have been generated. */
+    static void updateSite();
+
+    /** the .gz copy of a file, "index.html" -> "index.html.gz" */
+    static const File getGzipFile (const File& siteFile);
+
+    /** the .gz copy of a file, or all the copies in a dir (e.g. it'll be renamed or deleted) */
+    static void deleteGzipFiles (const File& siteFileOrDir);
+
+private:
+    /** writes the .gz copy of a file */
+    class CompressJob;
+    static ThreadPool& getCompressPool();
+
+    /** the size of the file which the .gz copy was written from (the ISIZE of the gzip format,
+        which is the size modulo 2^32), -1 if it can't be read */
+    static const int64 getOriginalSize (const File& gzipFile);
+
+    /** the .gz copy has the same content as the file */
+    static const bool isCopyOf (const File& gzipFile, const MemoryBlock& content);
+
+};
+
+
+#endif  // GZIPPROCESSOR_H_INCLUDED
@@ -13,10 +13,15 @@
 //=================================================================================================
 void HtmlProcessor::renderHtmlContent (const ValueTree& docTree,
                                        const File& tplFile,
-                                       const File& htmlFile)
+                                       const File& htmlFile,
+                                       Md2Html::BlockCache* blockCache)
 {
-    String tplStr (tplFile.existsAsFile() ? tplFile.loadFileAsString()
-                   : TRANS ("Please specify a template file. "));
+    HtmlTemplate::Ptr tpl (HtmlTemplate::getTemplate (tplFile));
+
+    if (tpl == nullptr)
+        tpl = new HtmlTemplate (TRANS ("Please specify a template file. "));
+
+    HtmlTemplate::Values values;
 
     // md to html
     const File mdDoc (DocTreeViewItem::getMdFileOrDir (docTree));
@@ -37,7 +42,7 @@ void HtmlProcessor::renderHtmlContent (const ValueTree& docTree,
     }
     
     // get the path which relative the site root-dir            
-    const String& rootRelativePath (getRelativePathToRoot (htmlFile));
+    const String& rootRelativePath (ProjectNodeTable::getRootRelativePath (docTree));
     
     // parse keywords-syntax here. must before md parse
     int startIndex = mdStrWithoutAbbrev.indexOf ("[keywords]");
@@ -47,39 +52,62 @@ void HtmlProcessor::renderHtmlContent (const ValueTree& docTree,
         const String kws (HtmlProcessor::getKeywordsLinks (rootRelativePath));
         mdStrWithoutAbbrev = mdStrWithoutAbbrev.replaceSection (startIndex, String ("[keywords]").length(), kws);
 
-        tplStr = tplStr.replace ("\n  <title>",
-                                 "\n  <style type=\"text/css\">\n"
-                                 "    table {width:100%; border-collapse:collapse;}\n"
-                                 "    table, td, th {border:0; padding:6px 5px 6px 5px;}\n"
-                                 "  </style>\n  <title>");
+        values.append (HtmlTemplate::headEnd,
+                       "  <style type=\"text/css\">\n"
+                       "    table {width:100%; border-collapse:collapse;}\n"
+                       "    table, td, th {border:0; padding:6px 5px 6px 5px;}\n"
+                       "  </style>\n");
     }
 
-    // parse mdString to html string
-    const String& htmlContentStr (Md2Html::mdStringToHtml (mdStrWithoutAbbrev));
+    // parse mdString to html string, then give its images their sizes
+    const String& htmlContentStr (MediaProcessor::addImageAttributes (
+                                  Md2Html::mdStringToHtml (mdStrWithoutAbbrev,
+                                                           Md2Html::Options::getLocalised(),
+                                                           blockCache), mdDoc, htmlFile));
 
     if (htmlContentStr.isEmpty())
         return;
 
-    // process code
+    // the images which have a width and height keep their aspect-ratio when they're
+    // scaled down by the style.css of the site (max-width: 100%)
+    if (htmlContentStr.contains ("\" height=\""))
+    {
+        values.append (HtmlTemplate::headEnd,
+                       "  <style type=\"text/css\">\n"
+                       "    img {height:auto;}\n"
+                       "  </style>\n");
+    }
+
+    // process code. the code-blocks which have been highlighted by Md2Html are
+    // <pre><code class=hljs>, only the others need hl.js
     if (htmlContentStr.contains ("<pre><code>"))
     {
-        tplStr = tplStr.replace ("\n  <title>",
-                                 "\n  <script src = \""
-                                 + rootRelativePath + "add-in/hl.js\"></script>\n"
-                                 "  <script>hljs.initHighlightingOnLoad(); </script>\n"
-                                 "  <title>");
+        values.append (HtmlTemplate::headEnd,
+                       "  <script src = \""
+                       + rootRelativePath + "add-in/hl.js\"></script>\n"
+                       "  <script>hljs.initHighlightingOnLoad(); </script>\n");
     }
 
-    processTplTags (docTree, htmlFile, tplStr);
+    processTplTags (docTree, *tpl, values);
     const String& siteName (" - " + FileTreeContainer::projectTree.getProperty ("title").toString());
 
-    // process head-tags and generate the html file
-    htmlFile.appendText (tplStr.replace ("{{keywords}}", keywords)
-                         .replace ("{{author}}", FileTreeContainer::projectTree.getProperty ("owner").toString())
-                         .replace ("{{description}}", docTree.getProperty ("description").toString())
-                         .replace ("{{title}}", docTree.getProperty ("title").toString() + siteName)
-                         .replace ("{{siteRelativeRootPath}}", rootRelativePath)
-                         .replace ("{{content}}", htmlContentStr));
+    // head-tags and the content
+    values.set (HtmlTemplate::keywords, keywords);
+    values.set (HtmlTemplate::author, FileTreeContainer::projectTree.getProperty ("owner").toString());
+    values.set (HtmlTemplate::description, docTree.getProperty ("description").toString());
+    values.set (HtmlTemplate::title, docTree.getProperty ("title").toString() + siteName);
+    values.set (HtmlTemplate::siteRelativeRootPath, rootRelativePath);
+    values.set (HtmlTemplate::content, htmlContentStr);
+
+    // generate the html file in one pass, the page won't be joined into one String
+    ScopedPointer<OutputStream> out = createHtmlOutputStream (htmlFile);
+
+    if (out != nullptr)
+    {
+        tpl->write (*out, values);
+        out->flush();
+        out = nullptr;
+    }
 
     copyDocMediasToSite (mdDoc, htmlFile, htmlContentStr);
 }
@@ -87,10 +115,8 @@ void HtmlProcessor::renderHtmlContent (const ValueTree& docTree,
 //=================================================================================================
 const String HtmlProcessor::getRelativePathToRoot (const File &htmlFile)
 {
-    const String htmlFilePath (htmlFile.getFullPathName());
-    const String webRootDirPath (FileTreeContainer::projectFile.getParentDirectory().getFullPathName()
-                                 + File::separator + "site");
-    const String tempStr (htmlFilePath.trimCharactersAtStart (webRootDirPath));
+    // the dirs between the root of the site and the html
+    const String tempStr (htmlFile.getRelativePathFrom (FileTreeContainer::projectFile.getSiblingFile ("site")));
     String cssRelativePath;
 
     for (int i = tempStr.length(); --i >= 0;)
@@ -103,9 +129,9 @@ const String HtmlProcessor::getRelativePathToRoot (const File &htmlFile)
 }
 
 //=================================================================================================
-const String HtmlProcessor::getSiteLink (const File &htmlFile)
+const String HtmlProcessor::getSiteLink (const ValueTree& tree)
 {
-    const String& rootPathLink (getRelativePathToRoot (htmlFile) + "index.html");
+    const String& rootPathLink (ProjectNodeTable::getRootRelativePath (tree) + "index.html");
     const String& siteTitle (FileTreeContainer::projectTree.getProperty ("title").toString());
 
     return "<a href=\"" + rootPathLink + "\">" + siteTitle.upToFirstOccurrenceOf (" ", false, true) + "</a>";
@@ -124,12 +150,12 @@ const bool HtmlProcessor::atLeastHasOneMenu (const ValueTree& tree)
 }
 
 //=================================================================================================
-const File HtmlProcessor::createArticleHtml (ValueTree& docTree, bool saveProject)
+const File HtmlProcessor::createArticleHtml (ValueTree& docTree, bool saveProject,
+                                             Md2Html::BlockCache* blockCache)
 {
     jassert (FileTreeContainer::projectTree.isValid());
 
-    const String docPath (DocTreeViewItem::getMdFileOrDir (docTree).getFullPathName());
-    const File htmlFile (File (docPath.replace ("docs", "site")).withFileExtension ("html"));
+    const File htmlFile (DocTreeViewItem::getHtmlFileOrDir (docTree));
 
     if ((bool)docTree.getProperty ("needCreateHtml") || !htmlFile.existsAsFile())
     {
@@ -144,7 +170,7 @@ const File HtmlProcessor::createArticleHtml (ValueTree& docTree, bool saveProjec
 
             // generate the doc's html
             htmlFile.create();
-            renderHtmlContent (docTree, tplFile, htmlFile);
+            renderHtmlContent (docTree, tplFile, htmlFile, blockCache);
 
             docTree.setProperty ("needCreateHtml", false, nullptr);
 
@@ -231,25 +257,14 @@ const File HtmlProcessor::createIndexHtml (ValueTree& dirTree, bool saveProject)
                                 + dirTree.getProperty ("tplFile").toString());
 
             // get the path which relative the site root-dir, for css path            
-            const String htmlFilePath (indexHtml.getFullPathName());
-            const String webRootDirPath (FileTreeContainer::projectFile.getParentDirectory().getFullPathName()
-                                         + File::separator + "site");
-            const String tempStr (htmlFilePath.trimCharactersAtStart (webRootDirPath));
-            String cssRelativePath;
-
-            for (int i = tempStr.length(); --i >= 0;)
-            {
-                if (tempStr[i] == File::separator)
-                    cssRelativePath << String ("../");
-            }
+            const String cssRelativePath (ProjectNodeTable::getRootRelativePath (dirTree));
 
-            String tplStr (tplFile.existsAsFile() ? tplFile.loadFileAsString() : String());
+            const HtmlTemplate::Ptr tpl (HtmlTemplate::getTemplate (tplFile));
 
             // when missing render dir (no tpl)
-            if (tplStr.isEmpty())
+            if (tpl == nullptr || tpl->isEmpty())
             {
-                indexHtml.create();
-                indexHtml.appendText (TRANS ("Please specify a template file. "));
+                writeHtmlFile (indexHtml, TRANS ("Please specify a template file. "));
 
                 return indexHtml;
             }
@@ -261,52 +276,40 @@ const File HtmlProcessor::createIndexHtml (ValueTree& dirTree, bool saveProject)
             const String siteName (dirTree.getType().toString() == "wdtpProject"
                                    ? String() : " - " + FileTreeContainer::projectTree.getProperty ("title").toString());
 
-            tplStr = tplStr.replace ("{{siteRelativeRootPath}}", cssRelativePath)
-                .replace ("{{author}}", indexAuthorStr)
-                .replace ("{{title}}", indexTileStr + siteName)
-                .replace ("{{keywords}}", indexKeywordsStr)
-                .replace ("{{description}}", indexDescStr);
+            HtmlTemplate::Values values;
+            values.set (HtmlTemplate::siteRelativeRootPath, cssRelativePath);
+            values.set (HtmlTemplate::author, indexAuthorStr);
+            values.set (HtmlTemplate::title, indexTileStr + siteName);
+            values.set (HtmlTemplate::keywords, indexKeywordsStr);
+            values.set (HtmlTemplate::description, indexDescStr);
 
-            processTplTags (dirTree, indexHtml, tplStr);
+            processTplTags (dirTree, *tpl, values);
 
             // list for book
-            if (tplStr.contains ("{{bookList}}"))
+            if (tpl->uses (HtmlTemplate::bookList))
             {
-                tplStr = tplStr.replace ("{{bookList}}", getBookList (dirTree));
-                indexHtml.create();
-                indexHtml.appendText (tplStr);
+                values.set (HtmlTemplate::bookList, getBookList (dirTree));
+                writeHtmlFile (indexHtml, *tpl, values);
             }
 
             // list for blog
-            if (tplStr.contains ("{{blogList}}"))
+            if (tpl->uses (HtmlTemplate::blogList))
             {
-                const StringArray fileLinks (getBlogList (dirTree));
-                const int howManyFiles = fileLinks.size() / 3;
-                const int howManyPages = howManyFiles / 10 + (howManyFiles % 10 == 0 ? 0 : 1);
+                const StringArray pages (getBlogListPages (dirTree));
 
-                if (howManyFiles < 1)
+                if (pages.size() < 1)
                 {
-                    indexHtml.deleteFile();
-                    indexHtml.create();
-
-                    const String listHtmlStr = tplStr.replace ("{{blogList}}", String());
-                    indexHtml.appendText (listHtmlStr);
+                    values.set (HtmlTemplate::blogList, String());
+                    writeHtmlFile (indexHtml, *tpl, values);
                 }
                 else  // devide to many pages
                 {
-                    for (int i = 0; i < howManyPages; ++i)
+                    for (int i = 0; i < pages.size(); ++i)
                     {
-                        StringArray pageLinks;
-                        pageLinks.addArray (fileLinks, i * 30, 30);
-                        pageLinks.add (getPageNavi (howManyPages, i + 1));
-
-                        const String listHtmlStr = tplStr.replace ("{{blogList}}",
-                                                                   "<div>" + pageLinks.joinIntoString (newLine) + "</div>");
+                        values.set (HtmlTemplate::blogList, pages[i]);
 
                         const File& indexFile (indexHtml.getSiblingFile ("index-" + String (i + 1) + ".html"));
-                        indexFile.deleteFile();
-                        indexFile.create();
-                        indexFile.appendText (listHtmlStr);
+                        writeHtmlFile (indexFile, *tpl, values);
                     }
 
                     indexHtml.getSiblingFile ("index-1.html").moveFileTo (indexHtml);
@@ -328,183 +331,526 @@ const File HtmlProcessor::createIndexHtml (ValueTree& dirTree, bool saveProject)
 }
 
 //=================================================================================================
-const String HtmlProcessor::extractKeywordsOfDocs (const ValueTree& dirTree)
+OutputStream* HtmlProcessor::createHtmlOutputStream (const File& htmlFile)
 {
-    // extract all keywords of each doc of this dir
-    StringArray keywordsArray;
-    extractKeywords (dirTree, keywordsArray);
+    FileOutputStream* fileStream = htmlFile.createOutputStream();
+
+    if (fileStream != nullptr && (bool)FileTreeContainer::projectTree.getProperty ("minify"))
+        return new HtmlMinifier (fileStream, true);
+
+    return fileStream;
+}
+
+//=================================================================================================
+void HtmlProcessor::writeHtmlFile (const File& htmlFile, const String& htmlStr)
+{
+    htmlFile.deleteFile();
+    ScopedPointer<OutputStream> out = createHtmlOutputStream (htmlFile);
+
+    if (out != nullptr)
+        out->writeText (htmlStr, false, false);
+}
+
+void HtmlProcessor::writeHtmlFile (const File& htmlFile, const HtmlTemplate& tpl,
+                                   const HtmlTemplate::Values& values)
+{
+    htmlFile.deleteFile();
+    ScopedPointer<OutputStream> out = createHtmlOutputStream (htmlFile);
+
+    if (out != nullptr)
+        tpl.write (*out, values);
+}
+
+//=================================================================================================
+void HtmlProcessor::minifyAddInFiles()
+{
+    const bool minifyThem = (bool)FileTreeContainer::projectTree.getProperty ("minify");
+    const File addInDir (FileTreeContainer::projectFile.getSiblingFile ("site").getChildFile ("add-in"));
+    const File originalDir (FileTreeContainer::projectFile.getSiblingFile ("cache").getChildFile ("add-in"));
+
+    Array<File> files;
+    addInDir.findChildFiles (files, File::findFiles, false, "*.css;*.js");
+
+    for (int i = files.size(); --i >= 0; )
+    {
+        const File& siteFile (files.getReference (i));
+        const File originalFile (originalDir.getChildFile (siteFile.getFileName()));
+        const String siteStr (siteFile.loadFileAsString());
+
+        const bool isMinifiedCopy = originalFile.existsAsFile()
+            && siteStr == getMinifiedAddIn (originalFile, originalFile.loadFileAsString());
+
+        if (isMinifiedCopy)
+        {
+            if (!minifyThem)
+                originalFile.copyFileTo (siteFile);
+        }
+        else if (minifyThem)
+        {
+            // a new one, or it has been edited (replaced) in the site
+            originalDir.createDirectory();
+            siteFile.copyFileTo (originalFile);
+
+            const String minifiedStr (getMinifiedAddIn (siteFile, siteStr));
+
+            // only rewrite it when it does change
+            if (minifiedStr != siteStr)
+                siteFile.replaceWithText (minifiedStr, false, false);
+        }
+        else
+        {
+            originalFile.deleteFile();
+        }
+    }
+}
+
+//=================================================================================================
+const File HtmlProcessor::getAddInSource (const File& addInFile)
+{
+    const File originalFile (FileTreeContainer::projectFile.getSiblingFile ("cache")
+                             .getChildFile ("add-in").getChildFile (addInFile.getFileName()));
+
+    if (originalFile.existsAsFile()
+        && addInFile.loadFileAsString() == getMinifiedAddIn (originalFile, originalFile.loadFileAsString()))
+        return originalFile;
+
+    return addInFile;
+}
+
+//=================================================================================================
+const String HtmlProcessor::getMinifiedAddIn (const File& addInFile, const String& content)
+{
+    if (addInFile.hasFileExtension ("css"))
+        return HtmlMinifier::minifyCss (content);
+
+    return HtmlMinifier::minifyJs (content);
+}
+
+//=================================================================================================
+/** Which docs use each keyword (the "keywords" of a doc, separated by ',' or the Chinese ',').
+    A keyword is the same one whatever its case, and it's named as it was seen first.
+
+    The index of a dir is only a snapshot of it (for its keywords table). The index of the
+    project (see OfProject) is built once and follows the changes of the project: when the
+    keywords of a doc are changed, or a doc is added or removed, only the keywords of that
+    doc are touched. */
+class HtmlProcessor::KeywordIndex
+{
+public:
+    struct Keyword
+    {
+        String name;
+        Array<ValueTree> docs;
+    };
+
+    /** the index of the docs in this dir */
+    explicit KeywordIndex (const ValueTree& dirTree)
+    {
+        addDocs (dirTree);
+    }
+
+    virtual ~KeywordIndex()     { }
+
+    class OfProject;
+
+    /** The keywords which more docs use first, then by their names (in the natural order).
+        The docs of each keyword are the newest first. */
+    void getSortedKeywords (Array<Keyword>& result) const
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = 0; i < keywords.size(); ++i)
+            result.add (*keywords.getUnchecked (i));
+
+        KeywordSorter keywordSorter;
+        result.sort (keywordSorter, true);
+
+        DocSorter docSorter;
+
+        for (int i = result.size(); --i >= 0; )
+            result.getReference (i).docs.sort (docSorter, true);
+    }
+
+protected:
+    //=============================================================================================
+    struct KeywordSorter
+    {
+        int compareElements (const Keyword& first, const Keyword& second) const
+        {
+            if (first.docs.size() != second.docs.size())
+                return second.docs.size() - first.docs.size();
+
+            return first.name.compareNatural (second.name);
+        }
+    };
+
+    struct DocSorter
+    {
+        int compareElements (const ValueTree& first, const ValueTree& second) const
+        {
+            return second.getProperty ("createDate").toString().compare (first.getProperty ("createDate").toString());
+        }
+    };
+
+    /** the keywords of a doc, each of them only once */
+    static const StringArray getKeywordsOf (const ValueTree& docTree)
+    {
+        StringArray docKeywords;
+        docKeywords.addTokens (docTree.getProperty ("keywords").toString()
+                               .replace (CharPointer_UTF8 ("\xef\xbc\x8c"), ","), ",", String()); // Chinese ','
+        docKeywords.trim();
+        docKeywords.removeEmptyStrings();
+        docKeywords.removeDuplicates (true);
+
+        return docKeywords;
+    }
 
-    keywordsArray.appendNumbersToDuplicates (true, false, CharPointer_UTF8 ("--"), CharPointer_UTF8 (""));
-    keywordsArray.sortNatural();
+    //=============================================================================================
+    KeywordIndex()      { }
 
-    // remove duplicates and remain the last which include "-x (times)"
-    for (int i = keywordsArray.size(); --i >= 1; )
+    /** the tree, and the docs in it if it's a dir */
+    void addDocs (const ValueTree& tree)
     {
-        if (keywordsArray[i].upToLastOccurrenceOf ("--", false, true).compareIgnoreCase (
-            keywordsArray[i - 1].upToLastOccurrenceOf ("--", false, true)) == 0)
+        const ScopedLock sl (lock);
+
+        if (tree.getType().toString() == "doc")
         {
-            keywordsArray.remove (i - 1);
+            const StringArray& docKeywords (getKeywordsOf (tree));
+
+            if (docKeywords.size() > 0)
+                addDoc (tree, docKeywords);
         }
+
+        for (int i = tree.getNumChildren(); --i >= 0; )
+            addDocs (tree.getChild (i));
     }
 
-    // sort by duplicate-times
-    for (int i = 0; i < keywordsArray.size(); ++i)
+    virtual void addDoc (const ValueTree& docTree, const StringArray& docKeywords)
     {
-        for (int j = 0; j < keywordsArray.size() - 1; ++j)
+        for (int i = 0; i < docKeywords.size(); ++i)
         {
-            if (keywordsArray[j].fromLastOccurrenceOf ("--", false, true).getIntValue() <
-                keywordsArray[j + 1].fromLastOccurrenceOf ("--", false, true).getIntValue())
+            const String key (docKeywords[i].toLowerCase());
+            Keyword* keyword = keywordsByKey[key];
+
+            if (keyword == nullptr)
             {
-                const String str (keywordsArray[j]);
-                keywordsArray.getReference (j) = keywordsArray[j + 1];
-                keywordsArray.getReference (j + 1) = str;
+                keyword = keywords.add (new Keyword());
+                keyword->name = docKeywords[i];
+                keywordsByKey.set (key, keyword);
             }
+
+            keyword->docs.add (docTree);
         }
     }
 
-    // move the '123XX' to the end
-    StringArray tempStrs;
-
-    for (int i = 0; i < keywordsArray.size(); ++i)
+    /** docKeywords: the ones which the doc was added with */
+    void removeDoc (const ValueTree& docTree, const StringArray& docKeywords)
     {
-        if (!keywordsArray[i].contains ("--"))
+        for (int i = 0; i < docKeywords.size(); ++i)
         {
-            tempStrs.add (keywordsArray[i]);
-            keywordsArray.remove (i);
-            --i;
+            const String key (docKeywords[i].toLowerCase());
+            Keyword* const keyword = keywordsByKey[key];
+            jassert (keyword != nullptr);
+
+            if (keyword == nullptr)
+                continue;
+
+            keyword->docs.removeFirstMatchingValue (docTree);
+
+            if (keyword->docs.size() == 0)
+            {
+                keywordsByKey.remove (key);
+                keywords.removeObject (keyword);
+            }
         }
     }
 
-    keywordsArray.addArray (tempStrs);
-    String keywords (keywordsArray.joinIntoString (","));
-
-    if (keywords.substring (0, 1) == ",")
-        keywords = keywords.substring (1);
+    //=============================================================================================
+    OwnedArray<Keyword> keywords;
+    HashMap<String, Keyword*> keywordsByKey;
+    CriticalSection lock;
 
-    //DBGX (keywords);
-    return keywords;
-}
+private:
+    JUCE_DECLARE_NON_COPYABLE (KeywordIndex)
+};
 
 //=================================================================================================
-const String HtmlProcessor::getKeywordsLinks (const String& rootPath)
+/** The index of the project, which follows its changes.
+
+    Each doc which has keywords is kept with the keywords which it was added with, so when its
+    keywords are changed or it's removed, it's only taken out of those keywords. A ValueTree
+    can't be hashed, so a doc is found by its create date, then the tree itself is compared.
+    After it has been redated it's found by its name instead. */
+class HtmlProcessor::KeywordIndex::OfProject  : public KeywordIndex,
+                                                 private ProjectCache
 {
-    StringArray kws;
-    kws.addTokens (extractKeywordsOfDocs (FileTreeContainer::projectTree), ",", String());
+public:
+    OfProject()
+    {
+        addDocs (FileTreeContainer::projectTree);
+    }
 
-    for (int i = kws.size(); --i >= 0; )
+private:
+    //=============================================================================================
+    struct IndexedDoc
     {
-        if (kws[i].contains ("--"))
-            kws.getReference (i) = kws[i].upToFirstOccurrenceOf ("--", false, true);
+        ValueTree doc;
+        String date;
+        String name;
+        StringArray keywords;
+        int index;      /**< in indexedDocs */
+    };
 
-        kws.getReference (i) = kws[i].replace (CharPointer_UTF8 ("\xef\xbc\x88"), " (")
-            .replace (CharPointer_UTF8 ("\xef\xbc\x89"), ")");
-        
-        Array<ValueTree> trees;
-        getDocTreeWithKeyword (FileTreeContainer::projectTree, kws[i], trees);        
+    typedef HashMap<String, Array<IndexedDoc*> > Chains;
+
+    static IndexedDoc* find (const Chains& chains, const String& key, const ValueTree& docTree)
+    {
+        const Array<IndexedDoc*> chain (chains[key]);
 
-        if (trees.size() == 1)
+        for (int i = chain.size(); --i >= 0; )
         {
-            String htmlPath (DocTreeViewItem::getHtmlFileOrDir (trees[0]).getFullPathName());
-            htmlPath = htmlPath.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName()
-                                         + File::separatorString, rootPath);
-            htmlPath = htmlPath.replace (File::separatorString, "/");
+            if (chain.getUnchecked (i)->doc == docTree)
+                return chain.getUnchecked (i);
+        }
 
-            kws.getReference (i) = "<li><a href=\"" + htmlPath + "\" title=\""
-                + trees[0].getProperty ("title").toString().replace (CharPointer_UTF8 ("\xef\xbc\x88"), " (")
-                .replace (CharPointer_UTF8 ("\xef\xbc\x89"), ")") + "\">"
-                + kws[i]
-                + "</a></li>";
+        return nullptr;
+    }
 
-            kws.getReference (i) = "<td align=center><ul>" + kws[i] + "</ul></td>";
-        }
+    static void link (Chains& chains, const String& key, IndexedDoc* indexedDoc)
+    {
+        Array<IndexedDoc*> chain (chains[key]);
+        chain.add (indexedDoc);
+        chains.set (key, chain);
+    }
+
+    static void unlink (Chains& chains, const String& key, IndexedDoc* indexedDoc)
+    {
+        Array<IndexedDoc*> chain (chains[key]);
+        chain.removeFirstMatchingValue (indexedDoc);
+
+        if (chain.size() == 0)
+            chains.remove (key);
         else
-        {
-            kws.getReference (i) = "<td align=center><ul><li><a>" + kws[i]
-                + " (" + String (trees.size()) + ")" + "</a><ul>";
+            chains.set (key, chain);
+    }
 
-            for (int j = trees.size(); --j >= 0; )
-            {
-                String htmlPath (DocTreeViewItem::getHtmlFileOrDir (trees[j]).getFullPathName());
-                htmlPath = htmlPath.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName()
-                                             + File::separatorString, rootPath);
+    //=============================================================================================
+    void addDoc (const ValueTree& docTree, const StringArray& docKeywords) override
+    {
+        KeywordIndex::addDoc (docTree, docKeywords);
 
-                htmlPath = htmlPath.replace (File::separatorString, "/");
+        IndexedDoc* const indexedDoc = indexedDocs.add (new IndexedDoc());
+        indexedDoc->doc = docTree;
+        indexedDoc->date = docTree.getProperty ("createDate").toString();
+        indexedDoc->name = docTree.getProperty ("name").toString();
+        indexedDoc->keywords = docKeywords;
+        indexedDoc->index = indexedDocs.size() - 1;
 
-                kws.getReference (i) = kws[i] +
-                    "<li><a href=\"" + htmlPath + "\">"
-                    + trees[j].getProperty ("title").toString()
-                    + "</a></li>";
-            }
+        link (docsByDate, indexedDoc->date, indexedDoc);
+        link (docsByName, indexedDoc->name, indexedDoc);
+    }
 
-            kws.getReference (i) = kws[i] + "</ul></li></ul></td>";
+    void forget (IndexedDoc* indexedDoc)
+    {
+        removeDoc (indexedDoc->doc, indexedDoc->keywords);
+        unlink (docsByDate, indexedDoc->date, indexedDoc);
+        unlink (docsByName, indexedDoc->name, indexedDoc);
+
+        // the last one takes its place
+        const int index = indexedDoc->index;
+        indexedDocs.swap (index, indexedDocs.size() - 1);
+        indexedDocs.getUnchecked (index)->index = index;
+        indexedDocs.removeLast();
+    }
+
+    /** the tree, and the docs in it if it's a dir */
+    void removeDocs (const ValueTree& tree)
+    {
+        if (tree.getType().toString() == "doc")
+        {
+            IndexedDoc* const indexedDoc = find (docsByDate, tree.getProperty ("createDate").toString(), tree);
+
+            if (indexedDoc != nullptr)
+                forget (indexedDoc);
         }
 
+        for (int i = tree.getNumChildren(); --i >= 0; )
+            removeDocs (tree.getChild (i));
     }
 
-    // table... column / line
-    kws.getReference (0) = "<tr>" + kws[0];
-    const int columnPreLine = 3;
+    //=============================================================================================
+    void projectChanged() override
+    {
+        const ScopedLock sl (lock);
+
+        docsByDate.clear();
+        docsByName.clear();
+        indexedDocs.clear();
+        keywordsByKey.clear();
+        keywords.clear();
+        addDocs (FileTreeContainer::projectTree);
+    }
 
-    for (int i = 1; i < kws.size(); ++i)
+    void propertyChanged (const ValueTree& tree, const Identifier& property) override
     {
-        if (i % columnPreLine == 0)
-            kws.getReference (i) = "<tr>" + kws[i];
+        if (tree.getType().toString() != "doc")
+            return;
 
-        else if ((i + 1) % columnPreLine == 0)
-            kws.getReference (i) = kws[i] + "</tr>";
+        const ScopedLock sl (lock);
+
+        if (property == Identifier ("keywords"))
+        {
+            removeDocs (tree);
+            addDocs (tree);
+        }
+        else if (property == Identifier ("createDate"))
+        {
+            IndexedDoc* const indexedDoc = find (docsByName, tree.getProperty ("name").toString(), tree);
+
+            if (indexedDoc != nullptr)
+            {
+                unlink (docsByDate, indexedDoc->date, indexedDoc);
+                indexedDoc->date = tree.getProperty ("createDate").toString();
+                link (docsByDate, indexedDoc->date, indexedDoc);
+            }
+        }
+        else if (property == Identifier ("name"))
+        {
+            IndexedDoc* const indexedDoc = find (docsByDate, tree.getProperty ("createDate").toString(), tree);
+
+            if (indexedDoc != nullptr)
+            {
+                unlink (docsByName, indexedDoc->name, indexedDoc);
+                indexedDoc->name = tree.getProperty ("name").toString();
+                link (docsByName, indexedDoc->name, indexedDoc);
+            }
+        }
     }
 
-    kws.insert (0, "<div class=keywordsMenu>");
-    kws.insert (1, "<table>");
-    kws.add ("</table></div>");
+    void treeAdded (const ValueTree&, const ValueTree& tree) override
+    {
+        addDocs (tree);
+    }
 
-    return kws.joinIntoString (newLine);
+    void treeRemoved (const ValueTree&, const ValueTree& tree) override
+    {
+        const ScopedLock sl (lock);
+        removeDocs (tree);
+    }
+
+    //=============================================================================================
+    OwnedArray<IndexedDoc> indexedDocs;
+    Chains docsByDate;
+    Chains docsByName;
+
+    JUCE_DECLARE_NON_COPYABLE (OfProject)
+};
+
+//=================================================================================================
+HtmlProcessor::KeywordIndex& HtmlProcessor::getKeywordIndex()
+{
+    static KeywordIndex::OfProject index;
+    return index;
 }
 
 //=================================================================================================
-void HtmlProcessor::extractKeywords (const ValueTree& tree,
-                                  StringArray& arrayToAdd)
+const String HtmlProcessor::extractKeywordsOfDocs (const ValueTree& dirTree)
 {
-    if (tree.getType().toString() == "doc")
+    Array<KeywordIndex::Keyword> keywords;
+
+    if (dirTree == FileTreeContainer::projectTree)
+    {
+        getKeywordIndex().getSortedKeywords (keywords);
+    }
+    else
+    {
+        const KeywordIndex dirIndex (dirTree);
+        dirIndex.getSortedKeywords (keywords);
+    }
+
+    // "keyword--3": it's used by 3 docs
+    StringArray keywordsArray;
+
+    for (int i = 0; i < keywords.size(); ++i)
     {
-        const String& keywords (tree.getProperty ("keywords").toString()
-                                .replace (CharPointer_UTF8 ("\xef\xbc\x8c"), ", ")); // Chinese ','
-        StringArray thisArray;
+        const KeywordIndex::Keyword& keyword (keywords.getReference (i));
 
-        thisArray.addTokens (keywords, ",", String());
-        thisArray.trim();
-        thisArray.removeEmptyStrings();
-        thisArray.removeDuplicates (true);
-        arrayToAdd.addArray (thisArray);
+        if (keyword.docs.size() > 1)
+            keywordsArray.add (keyword.name + "--" + String (keyword.docs.size()));
+        else
+            keywordsArray.add (keyword.name);
     }
 
-    for (int i = tree.getNumChildren(); --i >= 0; )
-        extractKeywords (tree.getChild (i), arrayToAdd);
+    return keywordsArray.joinIntoString (",");
 }
 
 //=================================================================================================
-void HtmlProcessor::getDocTreeWithKeyword (const ValueTree& tree, 
-                                           const String& keyword, 
-                                           Array<ValueTree>& result)
-{   
-    if (tree.getType().toString() == "doc")
+const String HtmlProcessor::getKeywordsLinks (const String& rootPath)
+{
+    Array<KeywordIndex::Keyword> keywords;
+    getKeywordIndex().getSortedKeywords (keywords);
+
+    const String sitePath (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName()
+                           + File::separatorString);
+    StringArray kws;
+
+    for (int i = 0; i < keywords.size(); ++i)
     {
-        StringArray kws;
-        const String keys (tree.getProperty ("keywords").toString()
-                           .replace (CharPointer_UTF8 ("\xef\xbc\x8c"), ",")); // chinese ','
+        const KeywordIndex::Keyword& keyword (keywords.getReference (i));
+        const String& name (keyword.name.replace (CharPointer_UTF8 ("\xef\xbc\x88"), " (")
+                            .replace (CharPointer_UTF8 ("\xef\xbc\x89"), ")"));
 
-        kws.addTokens (keys, ",", String());
-        kws.trim();
+        if (keyword.docs.size() == 1)
+        {
+            const ValueTree& doc (keyword.docs.getReference (0));
+            String htmlPath (DocTreeViewItem::getHtmlFileOrDir (doc).getFullPathName());
+            htmlPath = htmlPath.replace (sitePath, rootPath);
+            htmlPath = htmlPath.replace (File::separatorString, "/");
 
-        for (int i = kws.size(); --i >= 0; )
+            kws.add ("<td align=center><ul><li><a href=\"" + htmlPath + "\" title=\""
+                     + doc.getProperty ("title").toString().replace (CharPointer_UTF8 ("\xef\xbc\x88"), " (")
+                     .replace (CharPointer_UTF8 ("\xef\xbc\x89"), ")") + "\">"
+                     + name
+                     + "</a></li></ul></td>");
+        }
+        else
         {
-        	if (kws[i] == keyword)
-                result.add (tree);
+            String str ("<td align=center><ul><li><a>" + name
+                        + " (" + String (keyword.docs.size()) + ")" + "</a><ul>");
+
+            for (int j = 0; j < keyword.docs.size(); ++j)
+            {
+                const ValueTree& doc (keyword.docs.getReference (j));
+                String htmlPath (DocTreeViewItem::getHtmlFileOrDir (doc).getFullPathName());
+                htmlPath = htmlPath.replace (sitePath, rootPath);
+                htmlPath = htmlPath.replace (File::separatorString, "/");
+
+                str << "<li><a href=\"" << htmlPath << "\">"
+                    << doc.getProperty ("title").toString()
+                    << "</a></li>";
+            }
+
+            kws.add (str + "</ul></li></ul></td>");
         }
     }
 
-    for (int i = tree.getNumChildren(); --i >= 0; )
-        getDocTreeWithKeyword (tree.getChild (i), keyword, result);
+    // table... column / line
+    const int columnPreLine = 3;
+
+    for (int i = 0; i < kws.size(); ++i)
+    {
+        if (i % columnPreLine == 0)
+            kws.getReference (i) = "<tr>" + kws[i];
+
+        else if ((i + 1) % columnPreLine == 0)
+            kws.getReference (i) = kws[i] + "</tr>";
+    }
+
+    kws.insert (0, "<div class=keywordsMenu>");
+    kws.insert (1, "<table>");
+    kws.add ("</table></div>");
+
+    return kws.joinIntoString (newLine);
 }
 
 //=================================================================================================
@@ -564,118 +910,97 @@ const int HtmlProcessor::compareElements (const ValueTree& ft, const ValueTree&
 
 //=================================================================================================
 void HtmlProcessor::processTplTags (const ValueTree& docOrDirTree,
-                                 const File& htmlFile,
-                                 String& tplStr)
+                                    const HtmlTemplate& tpl,
+                                    HtmlTemplate::Values& values)
 {
-    const String& rootRelativePath (getRelativePathToRoot (htmlFile));
+    const String& rootRelativePath (ProjectNodeTable::getRootRelativePath (docOrDirTree));
 
     // title of this index.html
-    if (tplStr.contains ("{{titleOfDir}}"))
+    if (tpl.uses (HtmlTemplate::titleOfDir))
     {
-        tplStr = tplStr.replace ("{{titleOfDir}}", "<div align=center><h1>"
-                                 + docOrDirTree.getProperty ("title").toString()
-                                 + "</h1></div>" + newLine);
+        values.set (HtmlTemplate::titleOfDir, "<div align=center><h1>"
+                    + docOrDirTree.getProperty ("title").toString()
+                    + "</h1></div>" + newLine);
     }
 
-    // js
+    // js, it could have a {{siteRelativeRootPath}}
     if (docOrDirTree.isValid() && docOrDirTree.getProperty ("js").toString().trim().isNotEmpty())
     {
-        tplStr = tplStr.replace ("\n  <title>",
-                                 "\n" + docOrDirTree.getProperty ("js").toString().trim() + "\n\n"
-                                 "  <title>");
+        values.append (HtmlTemplate::headEnd,
+                       docOrDirTree.getProperty ("js").toString().trim()
+                       .replace ("{{siteRelativeRootPath}}", rootRelativePath) + "\n\n");
     }
 
     // site logo
-    if (tplStr.contains ("{{siteLogo}}"))
+    if (tpl.uses (HtmlTemplate::siteLogo))
     {
-        tplStr = tplStr.replace ("{{siteLogo}}",
-                                 "<div class=\"siteLogo\"><a href = \"" + rootRelativePath + "index.html\"><img src = \""
-                                 + rootRelativePath + "add-in/logo.png\" /></a></div>");
+        values.set (HtmlTemplate::siteLogo,
+                    "<div class=\"siteLogo\"><a href = \"" + rootRelativePath + "index.html\"><img src = \""
+                    + rootRelativePath + "add-in/logo.png\" /></a></div>");
     }
 
     // site menu
-    if (tplStr.contains ("{{siteMenu}}"))
+    if (tpl.uses (HtmlTemplate::siteMenu))
     {
         if (docOrDirTree.getType().toString() == "doc")
-            tplStr = tplStr.replace ("{{siteMenu}}", getSiteMenu (docOrDirTree.getParent()));
+            values.set (HtmlTemplate::siteMenu, getSiteMenu (docOrDirTree.getParent()));
         else
-            tplStr = tplStr.replace ("{{siteMenu}}", getSiteMenu (docOrDirTree));
+            values.set (HtmlTemplate::siteMenu, getSiteMenu (docOrDirTree));
     }
 
     // site navi
-    if (tplStr.contains ("{{siteNavi}}"))
-    {
-        tplStr = tplStr.replace ("{{siteNavi}}", getSiteNavi (docOrDirTree));
-    }
+    if (tpl.uses (HtmlTemplate::siteNavi))
+        values.set (HtmlTemplate::siteNavi, getSiteNavi (docOrDirTree));
 
     // site link
-    if (tplStr.contains ("{{siteLink}}"))
-    {
-        tplStr = tplStr.replace ("{{siteLink}}", getSiteLink (htmlFile));
-    }
+    if (tpl.uses (HtmlTemplate::siteLink))
+        values.set (HtmlTemplate::siteLink, getSiteLink (docOrDirTree));
 
     // back to previous level
-    if (tplStr.contains ("{{backPrevious}}"))
-    {
-        tplStr = tplStr.replace ("{{backPrevious}}", getBackPrevLevel());
-    }
+    if (tpl.uses (HtmlTemplate::backPrevious))
+        values.set (HtmlTemplate::backPrevious, getBackPrevLevel());
 
     // content tile
-    if (tplStr.contains ("{{contentTitle}}"))
-    {
-        tplStr = tplStr.replace ("{{contentTitle}}", getContentTitle (docOrDirTree));
-    }
+    if (tpl.uses (HtmlTemplate::contentTitle))
+        values.set (HtmlTemplate::contentTitle, getContentTitle (docOrDirTree));
 
     // content decription
-    if (tplStr.contains ("{{contentDesc}}"))
+    if (tpl.uses (HtmlTemplate::contentDesc))
     {
-        String descStr (docOrDirTree.getProperty ("description").toString());
-        descStr = "<div  align=\"center\"><blockquote>" + descStr + "</blockquote></div>";
-        tplStr = tplStr.replace ("{{contentDesc}}", descStr);
+        values.set (HtmlTemplate::contentDesc, "<div  align=\"center\"><blockquote>"
+                    + docOrDirTree.getProperty ("description").toString() + "</blockquote></div>");
     }
 
     // create and modified time
-    if (tplStr.contains ("{{createAndModifyTime}}"))
-    {
-        tplStr = tplStr.replace ("{{createAndModifyTime}}", getCreateAndModifyTime (docOrDirTree));
-    }
+    if (tpl.uses (HtmlTemplate::createAndModifyTime))
+        values.set (HtmlTemplate::createAndModifyTime, getCreateAndModifyTime (docOrDirTree));
 
     // prev and next
-    if (tplStr.contains ("{{previousAndNext}}"))
-    {
-        tplStr = tplStr.replace ("{{previousAndNext}}", getPrevAndNextArticel (docOrDirTree));
-    }
+    if (tpl.uses (HtmlTemplate::previousAndNext))
+        values.set (HtmlTemplate::previousAndNext, getPrevAndNextArticel (docOrDirTree));
 
     // ad
-    if (tplStr.contains ("{{ad}}"))
+    if (tpl.uses (HtmlTemplate::ad))
     {
-        tplStr = tplStr.replace ("{{ad}}", getAdStr (FileTreeContainer::projectTree.getProperty ("ad").toString(), htmlFile));
+        const String& adText (FileTreeContainer::projectTree.getProperty ("ad").toString());
+        values.set (HtmlTemplate::ad, getSiteFragments().getAdStr (adText, rootRelativePath));
     }
 
     // random 5
-    if (tplStr.contains ("{{random}}"))
-    {
-        tplStr = tplStr.replace ("{{random}}", getRandomArticels (docOrDirTree, 5));
-    }
+    if (tpl.uses (HtmlTemplate::random))
+        values.set (HtmlTemplate::random, getRandomArticels (docOrDirTree, 5));
 
     // contact
-    if (tplStr.contains ("{{contact}}"))
-    {
-        tplStr = tplStr.replace ("{{contact}}", getContactInfo());
-    }
+    if (tpl.uses (HtmlTemplate::contact))
+        values.set (HtmlTemplate::contact, getContactInfo());
 
     // click to top
-    if (tplStr.contains ("{{toTop}}"))
-    {
-        tplStr = tplStr.replace ("{{toTop}}", getToTop());
-    }
+    if (tpl.uses (HtmlTemplate::toTop))
+        values.set (HtmlTemplate::toTop, getToTop());
 
     // copyright on the bottom
-    if (tplStr.contains ("{{bottomCopyright}}"))
-    {
-        tplStr = tplStr.replace ("{{bottomCopyright}}", getCopyrightInfo());
-    }
-
+    if (tpl.uses (HtmlTemplate::bottomCopyright))
+        values.set (HtmlTemplate::bottomCopyright, getCopyrightInfo());
 }
 
 //=================================================================================================
@@ -720,37 +1045,235 @@ const String HtmlProcessor::processAbbrev (const ValueTree& docTree, const Strin
 }
 
 //=================================================================================================
-const String HtmlProcessor::getSiteMenu (const ValueTree& tree)
+/** in place of the relative root path ("../../") in the html which is shared by the pages of
+    different depths, a control character which Md2Html leaves as it is */
+static const char* const rootPathMark = "\x01";
+
+//=================================================================================================
+/** The parts of the pages which only depend on the project (not on the page itself, except
+    how deep it is in the site), made once and used by all the pages of a generation.
+
+    The menu and the ad are kept for each relative root path ("", "../", "../../"...), the
+    links of the docs (for the random articles) are kept once. They're forgotten when a doc or
+    dir is added, removed or moved, or its title, name, create date or "isMenu" has been
+    changed, and when another project is opened. The others are kept with
+    the property of the project which they came from, so they're made again when it changes.
+    The descriptions of the blog lists are kept with the hash of their markdown. */
+class HtmlProcessor::SiteFragments  : private ProjectCache
 {
-    ValueTree pTree (FileTreeContainer::projectTree.createCopy());
-    HtmlProcessor sorter (false);
-    pTree.sort (sorter, nullptr, false);
+public:
+    SiteFragments()  : docLinksReady (false)      { }
 
-    StringArray menuHtmlStr;
+    const String getSiteMenu (const String& rootPath)
+    {
+        const ScopedLock sl (lock);
 
-    if (atLeastHasOneMenu (pTree))
-        menuHtmlStr.add ("<div class=\"siteMenu\"><ul>");
-    else
-        return String();
+        if (!menus.contains (rootPath))
+            menus.set (rootPath, createSiteMenu (rootPath));
 
-    for (int i = 0; i < pTree.getNumChildren(); ++i)
+        return menus[rootPath];
+    }
+
+    const String getAdStr (const String& text, const String& rootPath)
     {
-        ValueTree fd (pTree.getChild (i));
+        const ScopedLock sl (lock);
 
-        if ((bool)fd.getProperty ("isMenu") && DocTreeViewItem::getMdFileOrDir (fd).exists())
+        if (text != adText)
         {
-            const File& dirIndex (DocTreeViewItem::getHtmlFileOrDir (fd));
-            const String& menuName (fd.getProperty ("title").toString());
-            String path;
+            ads.clear();
+            adText = text;
+        }
+
+        if (!ads.contains (rootPath))
+            ads.set (rootPath, createAdStr (text, rootPath));
+
+        return ads[rootPath];
+    }
+
+    /** 'howMany' docs (not the menus and not the page itself) in the order of the project
+        tree. They're chosen by Floyd's sampling, which draws only 'howMany' + 1 random numbers,
+        and the numbers are seeded by the path of the page, so a page has the same docs each
+        time it's generated until the docs of the project are changed. */
+    void getRandomDocLinks (const ValueTree& notIncludeThisTree, const File& htmlFile,
+                            const int howMany, Array<DocLink>& result)
+    {
+        const ScopedLock sl (lock);
+        const File siteDir (FileTreeContainer::projectFile.getSiblingFile ("site"));
+
+        if (!docLinksReady)
+        {
+            docLinks.clearQuick();
+            getDocLinks (FileTreeContainer::projectTree, siteDir, docLinks);
+            docLinksReady = true;
+        }
+
+        // + 1: one of them could be the page itself
+        const int numDocs = docLinks.size();
+        const int numChosen = jmin (howMany + 1, numDocs);
+        Random random (htmlFile.getRelativePathFrom (siteDir).replace ("\\", "/").hashCode64());
+        SortedSet<int> chosen;
+
+        for (int i = numDocs - numChosen; i < numDocs; ++i)
+        {
+            const int index = random.nextInt (i + 1);
+            chosen.add (chosen.contains (index) ? i : index);
+        }
+
+        for (int i = 0; i < chosen.size() && result.size() < howMany; ++i)
+        {
+            const DocLink& docLink (docLinks.getReference (chosen[i]));
+
+            if (docLink.doc != notIncludeThisTree)
+                result.add (docLink);
+        }
+    }
+
+    /** The description of a doc in the blog lists (mdStr, whose paths begin with the
+        rootPathMark) in html. It's converted once until it's changed, then the mark is
+        replaced for each index page which lists the doc. */
+    const String getBlogListDescription (const String& docPath, const String& mdStr,
+                                         const String& rootPath)
+    {
+        const ScopedLock sl (lock);
+
+        const int64 hash = mdStr.hashCode64();
+        Description description (descriptions[docPath]);
+
+        if (description.html.isEmpty() || description.hash != hash)
+        {
+            description.hash = hash;
+            description.html = Md2Html::mdStringToHtml (mdStr);
+            descriptions.set (docPath, description);
+        }
+
+        return description.html.replace (rootPathMark, rootPath);
+    }
+
+    const String getCopyrightInfo()
+    {
+        const ScopedLock sl (lock);
+        const String& copyright (FileTreeContainer::projectTree.getProperty ("copyright").toString());
+
+        if (copyrightInfo.isEmpty() || copyright != copyrightText)
+        {
+            copyrightText = copyright;
+            copyrightInfo = "<p><hr>\n"
+                "<table id=\"copyright\"><tr><td id=\"copyright\">" + copyright +
+                "</td><td id=\"copyright\" align=\"right\">Powered by "
+                "<a href=\"http://underwaySoft.com/works/wdtp/index.html\""
+                " target=\"_blank\">WDTP</a> </td></tr></table>";
+        }
+
+        return copyrightInfo;
+    }
+
+    const String getContactInfo()
+    {
+        const ScopedLock sl (lock);
+        const String& contact (FileTreeContainer::projectTree.getProperty ("contact").toString());
+
+        if (contactInfo.isEmpty() || contact != contactText)
+        {
+            contactText = contact;
+            contactInfo = "<div class=contact>" + contact + "</div>";
+        }
+
+        return contactInfo;
+    }
+
+private:
+    //=============================================================================================
+    void forgetMenus()
+    {
+        const ScopedLock sl (lock);
+        menus.clear();
+        docLinksReady = false;
+    }
+
+    void propertyChanged (const ValueTree&, const Identifier& property) override
+    {
+        // "modifyDate"... are changed for each page while generating
+        if (property == Identifier ("isMenu") || property == Identifier ("title")
+            || property == Identifier ("name") || property == Identifier ("createDate"))
+            forgetMenus();
+    }
+
+    void treeAdded (const ValueTree&, const ValueTree&) override       { forgetMenus(); }
+    void treeRemoved (const ValueTree&, const ValueTree&) override     { forgetMenus(); }
+    void childrenReordered (const ValueTree&) override                 { forgetMenus(); }
+
+    void projectChanged() override
+    {
+        const ScopedLock sl (lock);
+
+        forgetMenus();
+        descriptions.clear();
+    }
+
+    //=============================================================================================
+    HashMap<String, String> menus;
+    HashMap<String, String> ads;
+
+    struct Description
+    {
+        int64 hash;
+        String html;
+    };
+
+    HashMap<String, Description> descriptions;
+    Array<DocLink> docLinks;
+    bool docLinksReady;
+    String adText, copyrightText, copyrightInfo, contactText, contactInfo;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (SiteFragments)
+};
+
+//=================================================================================================
+HtmlProcessor::SiteFragments& HtmlProcessor::getSiteFragments()
+{
+    static SiteFragments fragments;
+    return fragments;
+}
+
+//=================================================================================================
+const String HtmlProcessor::getSiteMenu (const ValueTree& tree)
+{
+    return getSiteFragments().getSiteMenu (ProjectNodeTable::getRootRelativePath (tree));
+}
+
+//=================================================================================================
+const String HtmlProcessor::createSiteMenu (const String& rootPath)
+{
+    ValueTree pTree (FileTreeContainer::projectTree.createCopy());
+    HtmlProcessor sorter (false);
+    pTree.sort (sorter, nullptr, false);
+
+    StringArray menuHtmlStr;
+
+    if (atLeastHasOneMenu (pTree))
+        menuHtmlStr.add ("<div class=\"siteMenu\"><ul>");
+    else
+        return String();
+
+    for (int i = 0; i < pTree.getNumChildren(); ++i)
+    {
+        ValueTree fd (pTree.getChild (i));
+
+        if ((bool)fd.getProperty ("isMenu") && DocTreeViewItem::getMdFileOrDir (fd).exists())
+        {
+            const File& dirIndex (DocTreeViewItem::getHtmlFileOrDir (fd));
+            const String& menuName (fd.getProperty ("title").toString());
+            String path;
 
             if (fd.getType().toString() == "doc")
             {
-                path = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree))
+                path = rootPath
                     + fd.getProperty ("name").toString() + ".html";
             }
             else
             {
-                path = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree))
+                path = rootPath
                     + dirIndex.getParentDirectory().getFileName() + "/index.html";
             }
 
@@ -774,13 +1297,13 @@ const String HtmlProcessor::getSiteMenu (const ValueTree& tree)
 
                         if (sd.getType().toString() == "doc")
                         {
-                            sPath = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree))
+                            sPath = rootPath
                                 + dirIndex.getParentDirectory().getFileName() + "/"
                                 + sd.getProperty ("name").toString() + ".html";
                         }
                         else
                         {
-                            sPath = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree))
+                            sPath = rootPath
                                 + dirIndex.getParentDirectory().getFileName() + "/"
                                 + sDirIndex.getParentDirectory().getFileName() + "/index.html";
                         }
@@ -836,33 +1359,373 @@ const String HtmlProcessor::getCreateAndModifyTime (const ValueTree& tree)
     return "<div class=timeStr>" + createStr + "<br>" + modifyStr + "</div>";
 }
 
+//=================================================================================================
+/** The docs of the project (except the menus and the ones without a create date) in the order
+    of their create date, the previous and next article of a page are found by a binary search.
+
+    It's built when a project is opened, then kept up to date with the changes of the project.
+    When a doc is added, removed, moved, redated, renamed or retitled, the pages which link to
+    it (or did) as their previous or next article are kept, then marked as "needCreateHtml"
+    before the project is saved or generated (see applyToProject()), so the incremental
+    generation will update them.
+
+    The docs which have the same date are kept in the order which the old search found them,
+    and the first of them is the previous or next article. */
+class HtmlProcessor::ChronologicalIndex  : private ProjectCache
+{
+public:
+    ChronologicalIndex()
+    {
+        rebuild();
+    }
+
+    /** the docs which were created just before and just after the doc, the invalid trees if
+        there's no such doc */
+    void getNeighbours (const ValueTree& docTree, ValueTree& previous, ValueTree& next) const
+    {
+        const ScopedLock sl (lock);
+
+        const String& date (docTree.getProperty ("createDate").toString());
+        const int first = getFirstIndexFrom (date);
+        const int after = getFirstIndexAfter (date);
+
+        if (first > 0)
+            previous = entries.getReference (getFirstIndexFrom (entries.getReference (first - 1).date)).doc;
+
+        if (after < entries.size())
+            next = entries.getReference (after).doc;
+    }
+
+private:
+    //=============================================================================================
+    struct Entry
+    {
+        String date;
+        ValueTree doc;
+    };
+
+    struct DateSorter
+    {
+        int compareElements (const Entry& first, const Entry& second) const
+        {
+            return first.date.compare (second.date);
+        }
+    };
+
+    static const bool isIndexed (const ValueTree& tree)
+    {
+        return tree.getType().toString() == "doc"
+            && !(bool)tree.getProperty ("isMenu")
+            && tree.getProperty ("createDate").toString().isNotEmpty();
+    }
+
+    /** in the order of the old search: a tree itself, then its children from the last one */
+    static void getIndexedDocs (const ValueTree& tree, Array<ValueTree>& docs)
+    {
+        if (isIndexed (tree))
+            docs.add (tree);
+
+        for (int i = tree.getNumChildren(); --i >= 0; )
+            getIndexedDocs (tree.getChild (i), docs);
+    }
+
+    /** true if the old search gets to the first doc before the second one */
+    static const bool isFoundBefore (const ValueTree& first, const ValueTree& second)
+    {
+        if (second.isAChildOf (first))
+            return true;
+
+        // the two trees (or their dirs) which are in the same dir
+        ValueTree firstOrDir (first);
+
+        while (firstOrDir.getParent().isValid() && !second.isAChildOf (firstOrDir.getParent()))
+            firstOrDir = firstOrDir.getParent();
+
+        const ValueTree dir (firstOrDir.getParent());
+        ValueTree secondOrDir (second);
+
+        while (secondOrDir.getParent().isValid() && secondOrDir.getParent() != dir)
+            secondOrDir = secondOrDir.getParent();
+
+        // the children are searched from the last one
+        return dir.indexOf (firstOrDir) > dir.indexOf (secondOrDir);
+    }
+
+    /** the page should be generated again, see applyToProject() */
+    void needCreate (const ValueTree& tree)
+    {
+        toCreate.addIfNotAlreadyThere (tree);
+    }
+
+    //=============================================================================================
+    void rebuild()
+    {
+        const ScopedLock sl (lock);
+
+        Array<ValueTree> docs;
+        getIndexedDocs (FileTreeContainer::projectTree, docs);
+
+        entries.clearQuick();
+
+        for (int i = 0; i < docs.size(); ++i)
+        {
+            Entry entry = { docs.getReference (i).getProperty ("createDate").toString(), docs.getReference (i) };
+            entries.add (entry);
+        }
+
+        DateSorter sorter;
+        entries.sort (sorter, true);
+    }
+
+    const int getFirstIndexFrom (const String& date) const
+    {
+        int start = 0, end = entries.size();
+
+        while (start < end)
+        {
+            const int middle = (start + end) / 2;
+
+            if (entries.getReference (middle).date < date)
+                start = middle + 1;
+            else
+                end = middle;
+        }
+
+        return start;
+    }
+
+    const int getFirstIndexAfter (const String& date) const
+    {
+        int start = 0, end = entries.size();
+
+        while (start < end)
+        {
+            const int middle = (start + end) / 2;
+
+            if (date < entries.getReference (middle).date)
+                end = middle;
+            else
+                start = middle + 1;
+        }
+
+        return start;
+    }
+
+    /** after the docs which have an earlier date, or the same date and are found before it */
+    void insert (const Entry& entry)
+    {
+        const int first = getFirstIndexFrom (entry.date);
+        int index = getFirstIndexAfter (entry.date);
+
+        while (index > first && isFoundBefore (entry.doc, entries.getReference (index - 1).doc))
+            --index;
+
+        entries.insert (index, entry);
+    }
+
+    void add (const ValueTree& doc)
+    {
+        Entry entry = { doc.getProperty ("createDate").toString(), doc };
+        insert (entry);
+        neighboursChanged (entry.date);
+    }
+
+    void remove (const ValueTree& tree)
+    {
+        StringArray dates;
+
+        for (int i = entries.size(); --i >= 0; )
+        {
+            const Entry& entry (entries.getReference (i));
+
+            if (entry.doc == tree || entry.doc.isAChildOf (tree))
+            {
+                dates.add (entry.date);
+                entries.remove (i);
+            }
+        }
+
+        for (int i = dates.size(); --i >= 0; )
+            neighboursChanged (dates[i]);
+    }
+
+    /** the docs of the dates just before and just after this date have another previous
+        or next article */
+    void neighboursChanged (const String& date)
+    {
+        const int first = getFirstIndexFrom (date);
+        const int after = getFirstIndexAfter (date);
+
+        if (first > 0)
+        {
+            for (int i = getFirstIndexFrom (entries.getReference (first - 1).date); i < first; ++i)
+                needCreate (entries.getReference (i).doc);
+        }
+
+        if (after < entries.size())
+        {
+            const int end = getFirstIndexAfter (entries.getReference (after).date);
+
+            for (int i = after; i < end; ++i)
+                needCreate (entries.getReference (i).doc);
+        }
+    }
+
+    //=============================================================================================
+    void projectChanged() override
+    {
+        const ScopedLock sl (lock);
+
+        toCreate.clearQuick();
+        rebuild();
+    }
+
+    /** the pages which should be generated again, and their dirs, or the incremental
+        generation won't get to them */
+    void applyToProject() override
+    {
+        Array<ValueTree> trees;
+
+        {
+            const ScopedLock sl (lock);
+            trees.swapWith (toCreate);
+        }
+
+        for (int i = 0; i < trees.size(); ++i)
+        {
+            for (ValueTree tree (trees.getReference (i)); tree.isValid(); tree = tree.getParent())
+                tree.setProperty ("needCreateHtml", true, nullptr);
+        }
+    }
+
+    void propertyChanged (const ValueTree& tree, const Identifier& property) override
+    {
+        const bool isDoc = (tree.getType().toString() == "doc");
+
+        if (isDoc && (property == Identifier ("createDate") || property == Identifier ("isMenu")))
+        {
+            const ScopedLock sl (lock);
+
+            remove (tree);
+
+            if (isIndexed (tree))
+                add (tree);
+
+            needCreate (tree);
+        }
+        else if ((isDoc && property == Identifier ("title"))
+                 || (tree.getType().toString() != "wdtpProject" && property == Identifier ("name")))
+        {
+            // the link of it (or of the docs in the renamed dir) on the pages beside them
+            const ScopedLock sl (lock);
+
+            Array<ValueTree> docs;
+            getIndexedDocs (tree, docs);
+
+            for (int i = docs.size(); --i >= 0; )
+                neighboursChanged (docs.getReference (i).getProperty ("createDate").toString());
+        }
+    }
+
+    void treeAdded (const ValueTree&, const ValueTree& tree) override
+    {
+        const ScopedLock sl (lock);
+
+        Array<ValueTree> docs;
+        getIndexedDocs (tree, docs);
+
+        for (int i = 0; i < docs.size(); ++i)
+            add (docs.getReference (i));
+    }
+
+    void treeRemoved (const ValueTree&, const ValueTree& tree) override
+    {
+        const ScopedLock sl (lock);
+        remove (tree);
+    }
+
+    /** only the order of the docs which have the same date could be changed */
+    void childrenReordered (const ValueTree& parentTree) override
+    {
+        const ScopedLock sl (lock);
+
+        Array<ValueTree> docs;
+
+        for (int i = parentTree.getNumChildren(); --i >= 0; )
+            getIndexedDocs (parentTree.getChild (i), docs);
+
+        for (int i = 0; i < docs.size(); ++i)
+        {
+            const String& date (docs.getReference (i).getProperty ("createDate").toString());
+            const int first = getFirstIndexFrom (date);
+            const int after = getFirstIndexAfter (date);
+
+            if (after - first < 2)
+                continue;
+
+            for (int j = first; j < after; ++j)
+            {
+                if (entries.getReference (j).doc == docs.getReference (i))
+                {
+                    const Entry entry (entries.getReference (j));
+                    entries.remove (j);
+                    insert (entry);
+                    break;
+                }
+            }
+
+            // the first of them is another one's previous or next article
+            neighboursChanged (date);
+        }
+    }
+
+    //=============================================================================================
+    Array<Entry> entries;
+    Array<ValueTree> toCreate;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (ChronologicalIndex)
+};
+
+//=================================================================================================
+HtmlProcessor::ChronologicalIndex& HtmlProcessor::getChronologicalIndex()
+{
+    static ChronologicalIndex index;
+    return index;
+}
+
+void HtmlProcessor::indexDocsOfProject()
+{
+    // the index follows the project tree once it's there
+    getChronologicalIndex();
+}
+
 //=================================================================================================
 const String HtmlProcessor::getPrevAndNextArticel (const ValueTree& tree)
 {
     String prevStr, nextStr;
 
-    ValueTree prevTree ("doc");
-    getPreviousTree (FileTreeContainer::projectTree, tree, prevTree);
+    ValueTree prevTree, nextTree;
+    getChronologicalIndex().getNeighbours (tree, prevTree, nextTree);
+
     const String prevName = prevTree.getProperty ("title").toString();
 
     if (prevName.isNotEmpty())
     {
         String prevPath = DocTreeViewItem::getHtmlFileOrDir (prevTree).getFullPathName();
         prevPath = prevPath.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName(), String());
-        prevPath = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree)) + prevPath.substring (1);
+        prevPath = ProjectNodeTable::getRootRelativePath (tree) + prevPath.substring (1);
         prevPath = prevPath.replace ("\\", "/");
         prevStr = TRANS ("Prev: ") + "<a href=\"" + prevPath + "\">" + prevName + "</a><br>";
     }
 
-    ValueTree nextTree ("doc");
-    getNextTree (FileTreeContainer::projectTree, tree, nextTree);
     const String nextName = nextTree.getProperty ("title").toString();
 
     if (nextName.isNotEmpty())
     {
         String nextPath = DocTreeViewItem::getHtmlFileOrDir (nextTree).getFullPathName();
         nextPath = nextPath.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName(), String());
-        nextPath = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (tree)) + nextPath.substring (1);
+        nextPath = ProjectNodeTable::getRootRelativePath (tree) + nextPath.substring (1);
         nextPath = nextPath.replace ("\\", "/");
         nextStr = TRANS ("Next: ") + "<a href=\"" + nextPath + "\">" + nextName + "</a>";
     }
@@ -874,77 +1737,29 @@ const String HtmlProcessor::getPrevAndNextArticel (const ValueTree& tree)
 const String HtmlProcessor::getRandomArticels (const ValueTree& notIncludeThisTree,
                                                const int howMany)
 {
-    StringArray links;
-    getLinkStrOfAlllDocTrees (FileTreeContainer::projectTree, notIncludeThisTree, links);
+    const File htmlFile (DocTreeViewItem::getHtmlFileOrDir (notIncludeThisTree));
+    const String& rootPath (ProjectNodeTable::getRootRelativePath (notIncludeThisTree));
+
+    Array<DocLink> docLinks;
+    getSiteFragments().getRandomDocLinks (notIncludeThisTree, htmlFile, howMany, docLinks);
 
-    // + 1: prevent a articel is the current, make sure enough
-    Array<int> randoms = getRandomInts (howMany + 1);
     StringArray randomLinks;
+    randomLinks.add ("<b>" + TRANS ("Random Posts:") + "</b>");
+    randomLinks.add ("<div class=randomArticels><ul>");
 
-    for (int i = 0; i < randoms.size(); ++i)
+    for (int i = 0; i < docLinks.size(); ++i)
     {
-        const int order = randoms[i];
-        randomLinks.add (links[order]);
+        randomLinks.add ("<li><a href=\"" + rootPath + docLinks.getReference (i).path + "\">"
+                         + docLinks.getReference (i).title + "</a></li>");
     }
 
-    randomLinks.removeEmptyStrings (true);
-
-    if (randomLinks.size() > howMany)
-        randomLinks.remove (0);  // remove the newest one
-
-    randomLinks.insert (0, "<div class=randomArticels><ul>");
-    randomLinks.insert (0, "<b>" + TRANS ("Random Posts:") + "</b>");
-
-    for (int j = randomLinks.size(); --j >= 2; )
-        randomLinks.getReference (j) = "<li>" + randomLinks[j] + "</li>";
-
     randomLinks.add ("</ul></div>");
 
     return randomLinks.joinIntoString (newLine);
 }
 
 //=================================================================================================
-void HtmlProcessor::getPreviousTree (const ValueTree& oTree,
-                                     const ValueTree& tree,
-                                     ValueTree& result)
-{
-    // prevent createDate is empty
-    if (result.getProperty ("createDate").toString() == String())
-        result.setProperty ("createDate", 1, nullptr);
-
-    if (oTree.getType().toString() == "doc" && !(bool)oTree.getProperty ("isMenu"))
-    {
-        if ((oTree.getProperty ("createDate").toString() < tree.getProperty ("createDate").toString())
-            && (oTree.getProperty ("createDate").toString() > result.getProperty ("createDate").toString()))
-            result = oTree;
-    }
-
-    for (int i = oTree.getNumChildren(); --i >= 0; )
-        getPreviousTree (oTree.getChild (i), tree, result);
-}
-
-//=================================================================================================
-void HtmlProcessor::getNextTree (const ValueTree& oTree,
-                                 const ValueTree& tree,
-                                 ValueTree& result)
-{
-    // prevent createDate is empty
-    if (result.getProperty ("createDate").toString() == String())
-        result.setProperty ("createDate", 3, nullptr);
-
-    if (oTree.getType().toString() == "doc" && !(bool)oTree.getProperty ("isMenu"))
-    {
-        if ((oTree.getProperty ("createDate").toString() > tree.getProperty ("createDate").toString())
-            && (oTree.getProperty ("createDate").toString() < result.getProperty ("createDate").toString()))
-            result = oTree;
-    }
-
-    for (int i = oTree.getNumChildren(); --i >= 0; )
-        getNextTree (oTree.getChild (i), tree, result);
-}
-
-//=================================================================================================
-const String HtmlProcessor::getAdStr (const String& text, const File& htmlFile)
+const String HtmlProcessor::createAdStr (const String& text, const String& rootPath)
 {
     StringArray orignalText;
     orignalText.addLines (text.trim());
@@ -954,7 +1769,7 @@ const String HtmlProcessor::getAdStr (const String& text, const File& htmlFile)
 
     for (int i = 0; i < orignalText.size(); ++i)
     {
-        const String& imgName (getRelativePathToRoot (htmlFile) + "add-in/"
+        const String& imgName (rootPath + "add-in/"
                                + orignalText[i].trim().upToFirstOccurrenceOf (" ", false, true));
         const String& link (orignalText[i].trim().fromFirstOccurrenceOf (" ", false, true));
         links.add ("<a href=\"" + link + "\" target=\"_blank\"><img src=\"" + imgName + "\"></a><br>");
@@ -980,55 +1795,24 @@ void HtmlProcessor::getDocNumbersOfTheDir (const ValueTree& dirTree, int& num)
 }
 
 //=================================================================================================
-const Array<int> HtmlProcessor::getRandomInts (const int howMany)
+void HtmlProcessor::getDocLinks (const ValueTree& tree, const File& siteDir, Array<DocLink>& docLinks)
 {
-    Array<int> values;
-    int maxValue = 0;
-    getDocNumbersOfTheDir (FileTreeContainer::projectTree, maxValue);
-    Random r (Time::currentTimeMillis());
-
-    for (int i = jmin (maxValue, howMany); --i >= 0; )
-    {
-        int randomValue = r.nextInt (maxValue);
-
-        for (int j = 0; j < values.size(); ++j)
-        {
-            if (values[j] == randomValue)
-            {
-                randomValue = r.nextInt (maxValue);
-                j = -1;  // here must be -1, because it'll ++j in for()
-            }
-        }
-
-        values.addUsingDefaultSort (randomValue);
-    }
-
-    return values;
-}
-
-//=================================================================================================
-void HtmlProcessor::getLinkStrOfAlllDocTrees (const ValueTree& fromThisTree,
-                                              const ValueTree& baseOnThisTree,
-                                              StringArray& linkStr)
-{
-    if (fromThisTree.getType().toString() == "doc" && fromThisTree != baseOnThisTree)
+    if (tree.getType().toString() == "doc")
     {
-        if (!(bool)fromThisTree.getProperty ("isMenu"))
+        if (!(bool)tree.getProperty ("isMenu"))
         {
-            const String text = fromThisTree.getProperty ("title").toString();
-
-            String path = DocTreeViewItem::getHtmlFileOrDir (fromThisTree).getFullPathName();
-            path = path.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName(), String());
-            path = getRelativePathToRoot (DocTreeViewItem::getHtmlFileOrDir (baseOnThisTree)) + path.substring (1);
-            path = path.replace ("\\", "/");
+            DocLink docLink;
+            docLink.doc = tree;
+            docLink.path = DocTreeViewItem::getHtmlFileOrDir (tree).getRelativePathFrom (siteDir).replace ("\\", "/");
+            docLink.title = tree.getProperty ("title").toString();
 
-            linkStr.add ("<a href=\"" + path + "\">" + text + "</a>");
+            docLinks.add (docLink);
         }
     }
     else
     {
-        for (int i = fromThisTree.getNumChildren(); --i >= 0; )
-            getLinkStrOfAlllDocTrees (fromThisTree.getChild (i), baseOnThisTree, linkStr);
+        for (int i = tree.getNumChildren(); --i >= 0; )
+            getDocLinks (tree.getChild (i), siteDir, docLinks);
     }
 }
 
@@ -1064,126 +1848,310 @@ void HtmlProcessor::getBookListLinks (const ValueTree& tree,
 }
 
 //=================================================================================================
-void HtmlProcessor::getBlogListHtmlStr (const ValueTree& tree,
-                                        const File& baseOnthisFile,
-                                        StringArray& linkStr)
+const HtmlProcessor::BlogListItem HtmlProcessor::getBlogListItem (const ValueTree& tree,
+                                                                 const String& rootPath)
 {
-    const String& rootPath (getRelativePathToRoot (baseOnthisFile));
-    String path = DocTreeViewItem::getHtmlFileOrDir (tree).getFullPathName();
-    path = path.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName(), String());
-    path = rootPath + path.substring (1);
-    path = path.replace ("\\", "/");
+    String sitePath (DocTreeViewItem::getHtmlFileOrDir (tree).getFullPathName());
+    sitePath = sitePath.replace (FileTreeContainer::projectFile.getSiblingFile ("site").getFullPathName(), String());
+    sitePath = sitePath.substring (1).replace ("\\", "/");
+
+    const String path (rootPath + sitePath);
+    const String& text (tree.getProperty ("title").toString());
+    const String& imgName (tree.getProperty ("thumbName").toString());
+
+    BlogListItem item;
+
+    // create and last modified date
+    item.date = "<img src=" + rootPath
+        + "add-in/createDate.png style=\"vertical-align:middle; display:inline-block\"> "
+        + tree.getProperty ("createDate").toString().dropLastCharacters (3) // drop seconds
+        + " &nbsp;&nbsp;<img src=" + rootPath
+        + "add-in/modifiedDate.png style=\"vertical-align:middle; display:inline-block\"> " +
+        tree.getProperty ("modifyDate").toString().dropLastCharacters (3); // drop seconds 
+
+    // 2 level dir and their link
+    const ValueTree parentTree (tree.getParent());
+    const ValueTree grandTree (parentTree.getParent());
+
+    // dir icon
+    if ((grandTree.isValid() && grandTree.getType().toString() != "wdtpProject")
+        || (parentTree.isValid() && parentTree.getType().toString() != "wdtpProject"))
+    {
+        item.date += " &nbsp;&nbsp;<img src=" + rootPath
+            + "add-in/dir.png style=\"vertical-align:middle; display:inline-block\"> ";
+    }
 
-    if (DocTreeViewItem::getHtmlFileOrDir (tree) != baseOnthisFile)
+    if (grandTree.isValid() && grandTree.getType().toString() != "wdtpProject")
     {
-        if (!(bool)tree.getProperty ("isMenu"))
+        const String parentPath (path.upToLastOccurrenceOf ("/", false, false)
+                                 .upToLastOccurrenceOf ("/", true, false) + "index.html");
+
+        item.date += "<a href=\"" + parentPath + "\">" +
+            grandTree.getProperty ("title").toString() + "</a>/";
+    }
+
+    if (parentTree.isValid() && parentTree.getType().toString() != "wdtpProject")
+    {
+        const String parentPath (path.upToLastOccurrenceOf ("/", true, false) + "index.html");
+        item.date += "<a href=\"" + parentPath + "\">" +
+            parentTree.getProperty ("title").toString() + "</a>";
+    }
+
+    // title and its link
+    item.title = "<a href=\"" + path + "\">" + text + "</a>";
+
+    // thumbnail, description and 'read more', their paths begin with the mark of the
+    // relative root path, so this doc's html is the same for all the index pages
+    const String markPath (rootPathMark + sitePath);
+    String descStr;
+
+    if (imgName.isNotEmpty() && (bool)tree.getProperty ("thumb"))
+    {
+        const String& imgPath (imgName.substring (0, 4) == "http" ? imgName
+                               : markPath.upToLastOccurrenceOf ("/", true, false) + imgName); // remove 'xxxx.html'
+        descStr += "<div><img src=\"" + imgPath + "\"></div><p>";
+    }
+
+    descStr += tree.getProperty ("description").toString() + "<div class=readMore align=right>"
+        + "<a href=\"" + markPath + "\">" + TRANS ("Read More") + "</a></div>";
+
+    item.description = getSiteFragments().getBlogListDescription (sitePath, descStr, rootPath);
+
+    return item;
+}
+
+//=================================================================================================
+/** The docs (except the menus) of each dir and all its sub-dirs, the newest first. The list
+    of a dir is merged from the sorted lists of its sub-dirs and its own docs (a k-way merge),
+    so each list is only sorted once, from the bottom of the project up.
+
+    A list is kept until the docs in the dir are changed: when a doc is added, removed, moved,
+    redated or becomes (or stops being) a menu, only the lists of its dirs are merged again.
+    All of them are forgotten when another project is opened. */
+class HtmlProcessor::BlogListings  : private ProjectCache
+{
+public:
+    struct Entry
+    {
+        String date;
+        ValueTree doc;
+    };
+
+    class Listing  : public ReferenceCountedObject
+    {
+    public:
+        typedef ReferenceCountedObjectPtr<Listing> Ptr;
+
+        explicit Listing (const ValueTree& dirTree) : dir (dirTree), indexDoc (-1)   { }
+
+        /** the doc whose html would be the index.html of the dir itself isn't in its list */
+        const int size() const noexcept                 { return entries.size() - (indexDoc != -1 ? 1 : 0); }
+
+        const ValueTree& getDoc (const int index) const
+        {
+            return entries.getReference (indexDoc != -1 && index >= indexDoc ? index + 1 : index).doc;
+        }
+
+        const ValueTree dir;
+        Array<Entry> entries;
+        int indexDoc;
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (Listing)
+    };
+
+    Listing::Ptr getListing (const ValueTree& dirTree)
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = listings.size(); --i >= 0; )
+        {
+            if (listings.getUnchecked (i)->dir == dirTree)
+                return listings.getUnchecked (i);
+        }
+
+        Listing::Ptr listing (new Listing (dirTree));
+        merge (*listing);
+        listings.add (listing);
+
+        return listing;
+    }
+
+private:
+    //=============================================================================================
+    struct NewestFirst
+    {
+        int compareElements (const Entry& first, const Entry& second) const
+        {
+            return second.date.compareIgnoreCase (first.date);
+        }
+    };
+
+    void merge (Listing& listing)
+    {
+        const File& indexFile (DocTreeViewItem::getHtmlFileOrDir (listing.dir));
+        NewestFirst newestFirst;
+
+        // its own docs and the lists of its sub-dirs, each of them is the newest first
+        Array<Entry> ownDocs;
+        ReferenceCountedArray<Listing> subListings;
+        int numEntries = 0;
+
+        for (int i = listing.dir.getNumChildren(); --i >= 0; )
         {
-            const String& text (tree.getProperty ("title").toString());
-            const String& imgName (tree.getProperty ("thumbName").toString());
-
-            String str (tree.getType().toString() == "doc" ? "doc" : "dir");
-
-            // create and last modified date
-            str += "@_^_#_%_@<img src=" + rootPath
-                + "add-in/createDate.png style=\"vertical-align:middle; display:inline-block\"> "
-                + tree.getProperty ("createDate").toString().dropLastCharacters (3) // drop seconds
-                + " &nbsp;&nbsp;<img src=" + rootPath
-                + "add-in/modifiedDate.png style=\"vertical-align:middle; display:inline-block\"> " +
-                // + " - " +
-                tree.getProperty ("modifyDate").toString().dropLastCharacters (3); // drop seconds 
-
-            // 2 level dir and their link
-            const ValueTree parentTree (tree.getParent());
-            const ValueTree grandTree (parentTree.getParent());
-
-            // dir icon
-            if ((grandTree.isValid() && grandTree.getType().toString() != "wdtpProject")
-                || (parentTree.isValid() && parentTree.getType().toString() != "wdtpProject"))
+            const ValueTree child (listing.dir.getChild (i));
+
+            if (child.getType().toString() != "doc")
             {
-                str += " &nbsp;&nbsp;<img src=" + rootPath
-                    + "add-in/dir.png style=\"vertical-align:middle; display:inline-block\"> ";
+                subListings.add (getListing (child));
+                numEntries += subListings.getLast()->entries.size();
             }
-
-            if (grandTree.isValid() && grandTree.getType().toString() != "wdtpProject")
+            else if (!(bool)child.getProperty ("isMenu"))
             {
-                const String parentPath (path.upToLastOccurrenceOf ("/", false, false)
-                                         .upToLastOccurrenceOf ("/", true, false) + "index.html");
-
-                str += "<a href=\"" + parentPath + "\">" +
-                    grandTree.getProperty ("title").toString() + "</a>/";
+                Entry entry = { child.getProperty ("createDate").toString(), child };
+                ownDocs.add (entry);
             }
+        }
 
-            if (parentTree.isValid() && parentTree.getType().toString() != "wdtpProject")
+        ownDocs.sort (newestFirst, true);
+        numEntries += ownDocs.size();
+
+        Array<const Array<Entry>*> lists;
+        lists.add (&ownDocs);
+
+        for (int i = 0; i < subListings.size(); ++i)
+            lists.add (&subListings.getUnchecked (i)->entries);
+
+        // always take the newest of the heads of the lists
+        Array<int> heads;
+        heads.insertMultiple (0, 0, lists.size());
+        listing.entries.ensureStorageAllocated (numEntries);
+
+        for (;;)
+        {
+            int newest = -1;
+
+            for (int i = 0; i < lists.size(); ++i)
             {
-                const String parentPath (path.upToLastOccurrenceOf ("/", true, false) + "index.html");
-                str += "<a href=\"" + parentPath + "\">" +
-                    parentTree.getProperty ("title").toString() + "</a>";
+                if (heads[i] < lists[i]->size()
+                    && (newest == -1 || newestFirst.compareElements (lists[i]->getReference (heads[i]),
+                                                                     lists[newest]->getReference (heads[newest])) < 0))
+                    newest = i;
             }
 
-            // title and its link
-            str = str + "@_^_#_%_@" + "<a href=\"" + path + "\">" + text + "</a>@_^_#_%_@";
+            if (newest == -1)
+                break;
+
+            const Entry& entry (lists[newest]->getReference (heads.getReference (newest)++));
+
+            if (newest == 0 && DocTreeViewItem::getHtmlFileOrDir (entry.doc) == indexFile)
+                listing.indexDoc = listing.entries.size();
+
+            listing.entries.add (entry);
+        }
+    }
+
+    /** the lists of the dir and all its parents */
+    void forgetListings (ValueTree dirTree)
+    {
+        const ScopedLock sl (lock);
 
-            if (imgName.isNotEmpty() && (bool)tree.getProperty ("thumb"))
+        for (; dirTree.isValid(); dirTree = dirTree.getParent())
+        {
+            for (int i = listings.size(); --i >= 0; )
             {
-                const String& imgPath (imgName.substring (0, 4) == "http" ? imgName
-                                       : path.upToLastOccurrenceOf ("/", true, false) + imgName); // remove 'xxxx.html'
-                str += "<div><img src=\"" + imgPath + "\"></div><p>";
+                if (listings.getUnchecked (i)->dir == dirTree)
+                    listings.remove (i);
             }
+        }
+    }
+
+    /** the lists of the dirs in a removed tree */
+    void forgetListingsIn (const ValueTree& tree)
+    {
+        const ScopedLock sl (lock);
 
-            // description
-            str += tree.getProperty ("description").toString() + "<div class=readMore align=right>"
-                + "<a href=\"" + path + "\">" + TRANS ("Read More") + "</a></div>";
+        for (int i = listings.size(); --i >= 0; )
+        {
+            const ValueTree& dir (listings.getUnchecked (i)->dir);
 
-            linkStr.add (str);
+            if (dir == tree || dir.isAChildOf (tree))
+                listings.remove (i);
         }
     }
 
-    for (int i = tree.getNumChildren(); --i >= 0; )
-        getBlogListHtmlStr (tree.getChild (i), baseOnthisFile, linkStr);
+    //=============================================================================================
+    void propertyChanged (const ValueTree& tree, const Identifier& property) override
+    {
+        // the "name" of a doc: it could be (or have been) the "index" of its dir
+        if (tree.getType().toString() == "doc"
+            && (property == Identifier ("createDate") || property == Identifier ("isMenu")
+                || property == Identifier ("name")))
+            forgetListings (tree.getParent());
+    }
+
+    void treeAdded (const ValueTree& parentTree, const ValueTree&) override
+    {
+        forgetListings (parentTree);
+    }
+
+    void treeRemoved (const ValueTree& parentTree, const ValueTree& tree) override
+    {
+        forgetListings (parentTree);
+        forgetListingsIn (tree);
+    }
+
+    void projectChanged() override
+    {
+        const ScopedLock sl (lock);
+        listings.clear();
+    }
+
+    //=============================================================================================
+    ReferenceCountedArray<Listing> listings;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (BlogListings)
+};
+
+//=================================================================================================
+HtmlProcessor::BlogListings& HtmlProcessor::getBlogListings()
+{
+    static BlogListings blogListings;
+    return blogListings;
 }
 
 //=================================================================================================
-const StringArray HtmlProcessor::getBlogList (const ValueTree& dirTree)
+const StringArray HtmlProcessor::getBlogListPages (const ValueTree& dirTree)
 {
     jassert (dirTree.getType().toString() != "doc");
-    const File& indexFile (DocTreeViewItem::getHtmlFileOrDir (dirTree));
-    StringArray filesLinkStr;
 
-    getBlogListHtmlStr (dirTree, indexFile, filesLinkStr);
-    filesLinkStr.sort (true);
+    const BlogListings::Listing::Ptr listing (getBlogListings().getListing (dirTree));
+    const String& rootPath (ProjectNodeTable::getRootRelativePath (dirTree));
 
-    for (int i = filesLinkStr.size(); --i >= 0; )
-    {
-        if (filesLinkStr[i].substring (0, 3) == "dir")
-            filesLinkStr.remove (i);
-    }
-
-    StringArray linkStr;
+    const int itemsPerPage = 10;
+    const int howManyFiles = listing->size();
+    const int howManyPages = howManyFiles / itemsPerPage + (howManyFiles % itemsPerPage == 0 ? 0 : 1);
+    StringArray pages;
 
-    for (int i = filesLinkStr.size(); --i >= 0; )
+    for (int i = 0; i < howManyPages; ++i)
     {
-        filesLinkStr.getReference (i) = filesLinkStr[i].substring (12); // remove "dir/doc @_^_#_%_@"
-        const String dateStr (filesLinkStr[i].upToFirstOccurrenceOf ("@_^_#_%_@", false, true));        
-        const String descStr (filesLinkStr[i].fromLastOccurrenceOf ("@_^_#_%_@", false, true));
-        const String titleStr (filesLinkStr[i].substring (dateStr.length() + 9).dropLastCharacters (descStr.length() + 9));
+        StringArray pageLinks;
 
-        linkStr.add (titleStr);
-        linkStr.add (dateStr);
-        linkStr.add (Md2Html::mdStringToHtml (descStr));
-    }
+        for (int j = i * itemsPerPage; j < jmin ((i + 1) * itemsPerPage, howManyFiles); ++j)
+        {
+            const BlogListItem& item (getBlogListItem (listing->getDoc (j), rootPath));
 
-    for (int i = 0; i < linkStr.size(); ++i)
-    {
-        if (0 == i % 3)
-            linkStr.getReference (i) = "<div class=listTitle>" + linkStr[i] + "</div>";
-        else if (1 == i % 3)
-            linkStr.getReference (i) = "<div class=listDate>" + linkStr[i] + "</div>";
-        else
-            linkStr.getReference (i) = "<div class=listDesc>" + linkStr[i] + "</div><hr>";
+            pageLinks.add ("<div class=listTitle>" + item.title + "</div>");
+            pageLinks.add ("<div class=listDate>" + item.date + "</div>");
+            pageLinks.add ("<div class=listDesc>" + item.description + "</div><hr>");
+        }
+
+        pageLinks.add (getPageNavi (howManyPages, i + 1));
+        pages.add ("<div>" + pageLinks.joinIntoString (newLine) + "</div>");
     }
 
-    //DBGX(linkStr.joinIntoString(newLine));
-    return linkStr;
+    return pages;
 }
 
 //=================================================================================================
@@ -1216,18 +2184,11 @@ const String HtmlProcessor::getBookList (const ValueTree& dirTree)
 //=========================================================================
 const String HtmlProcessor::getCopyrightInfo()
 {
-    return "<p><hr>\n"
-        "<table id=\"copyright\"><tr><td id=\"copyright\">" +
-        FileTreeContainer::projectTree.getProperty ("copyright").toString() +
-        "</td><td id=\"copyright\" align=\"right\">Powered by "
-        "<a href=\"http://underwaySoft.com/works/wdtp/index.html\""
-        " target=\"_blank\">WDTP</a> </td></tr></table>";
+    return getSiteFragments().getCopyrightInfo();
 }
 
 //=================================================================================================
 const String HtmlProcessor::getContactInfo()
 {
-    const String& contactStr (FileTreeContainer::projectTree.getProperty ("contact").toString());
-    return "<div class=contact>" + contactStr + "</div>";
+    return getSiteFragments().getContactInfo();
 }
-
@@ -15,14 +15,33 @@ struct HtmlProcessor
 {
     HtmlProcessor (const bool sortByReverse_) : sortByReverse (sortByReverse_) { }
 
-    /* let the arg-1 write to the arg-2, then generate arg-3 */
+    /* let the arg-1 write to the arg-2, then generate arg-3.
+       the blocks of the doc which are in the arg-4 (if any) won't be parsed again */
     static void renderHtmlContent (const ValueTree& docTree,
                                    const File& tplFile,
-                                   const File& htmlFile);
+                                   const File& htmlFile,
+                                   Md2Html::BlockCache* blockCache = nullptr);
 
-    static const File createArticleHtml (ValueTree& docTree, bool saveProjectAfterCreated);
+    static const File createArticleHtml (ValueTree& docTree, bool saveProjectAfterCreated,
+                                         Md2Html::BlockCache* blockCache = nullptr);
     static const File createIndexHtml (ValueTree& dirTree, bool saveProjectAfterCreated);
 
+    /** When the "minify" of the project is on, minify the css and js files in "site/add-in",
+        otherwise restore them. Their readable originals are kept in "cache/add-in" of the
+        project dir, a file which has been replaced (or edited) in the site is taken as a new
+        original. It'll be called after the htmls have been generated. */
+    static void minifyAddInFiles();
+
+    /** the readable original of a css or js file in "site/add-in" if it has been minified,
+        otherwise the file itself. for packing and exporting. */
+    static const File getAddInSource (const File& addInFile);
+
+    /** Index the docs of the project which has just been opened (for the previous and next
+        article of each page). The index follows the changes of the project after that. */
+    static void indexDocsOfProject();
+
+    /** The keywords of the docs in the dir, the ones which more docs use first, separated
+        by ','. The number of the docs is appended to a keyword if it's more than 1 ("xxx--3"). */
     static const String extractKeywordsOfDocs (const ValueTree& dirTree);
     static const String getKeywordsLinks (const String& rootPath);
 
@@ -36,15 +55,20 @@ struct HtmlProcessor
     static const String processAbbrev (const ValueTree& docTree, const String& originalStr);
 
 private:
-    /** Process tpl-file's tags */
-    static void processTplTags (const ValueTree& docOrDirTree, const File& htmlFile, String& tplStr);
-
-    static const StringArray getBlogList (const ValueTree& dirTree);
+    /** Give the tags which the template uses their values. the scripts of the doc or dir
+        (its "js") are added to the end of the head. */
+    static void processTplTags (const ValueTree& docOrDirTree, const HtmlTemplate& tpl,
+                                HtmlTemplate::Values& values);
+
+    /** the blog list of the dir's index.html, 10 items (and the navigation) for each page.
+        an empty array if there's no item */
+    static const StringArray getBlogListPages (const ValueTree& dirTree);
     static const String getBookList (const ValueTree& dirTree);
 
     /** generate site menu. 2 level dir/doc. that is: 
         if an item is tend for a site menu, it must not too deep. */
     static const String getSiteMenu (const ValueTree& tree);
+    static const String createSiteMenu (const String& rootPath);
 
     static const String getSiteNavi (const ValueTree& docTree);
     static const String getContentTitle (const ValueTree& tree);
@@ -56,41 +80,66 @@ private:
     static const String getCopyrightInfo();
     static const String getContactInfo();
 
+    /** the menu, ad, contact and copyright of the site, which are made once for all pages */
+    class SiteFragments;
+    static SiteFragments& getSiteFragments();
+
     static void copyDocMediasToSite (const File& mdFile, const File& htmlFile, const String& htmlStr);
 
+    /** a stream to write the html file, which minifies the html when the "minify"
+        of the project is on */
+    static OutputStream* createHtmlOutputStream (const File& htmlFile);
+    static void writeHtmlFile (const File& htmlFile, const String& htmlStr);
+    static void writeHtmlFile (const File& htmlFile, const HtmlTemplate& tpl,
+                               const HtmlTemplate::Values& values);
+    static const String getMinifiedAddIn (const File& addInFile, const String& content);
+
 public:
-    /** the end character in the result is '/' */
+    /** for an html which isn't a doc or dir of the project, the others get it from
+        ProjectNodeTable::getRootRelativePath(). the end character in the result is '/' */
     static const String getRelativePathToRoot (const File &htmlFile);
 
     /** extrct the project's title (up to first occurrence of ' ') */
-    static const String getSiteLink(const File &htmlFile);
+    static const String getSiteLink (const ValueTree& tree);
 
 private:
     static const bool atLeastHasOneMenu (const ValueTree& tree);
 
     //=================================================================================================
-    /** get a tree that create time previous/next the arg tree */
-    static void getPreviousTree (const ValueTree& oTree, const ValueTree& tree, ValueTree& result);
-    static void getNextTree (const ValueTree& oTree, const ValueTree& tree, ValueTree& result);
+    /** the docs in the order of their create date, for the previous/next article of a doc */
+    class ChronologicalIndex;
+    static ChronologicalIndex& getChronologicalIndex();
 
     /** ad text from the project setup. its formmat should be "imgName link"
         the img should place in site's add-in folder. */
-    static const String getAdStr (const String& text, const File& htmlFile);
-
-    /** return 'howMany' ints, range: 0 ~ getDocNumbersOfTheDir (projectTree). */
-    static const Array<int> getRandomInts (const int howMany);
-
-    /** get the arg tree's all child tree's link string. their path base on the arg 2 tree.
-        Note: not include the baseOnThisTree's link and not include create-date, desc, etc.
-        This method is for random articel. */
-    static void getLinkStrOfAlllDocTrees (const ValueTree& fromThisTree,
-                                          const ValueTree& baseOnThisTree,
-                                          StringArray& linkStr);
-
-    /** this method is for file-list of index.html. it'll include create date and extra info */
-    static void getBlogListHtmlStr (const ValueTree& tree,
-                                    const File& baseOnthisFile,
-                                    StringArray& linkStr);
+    static const String createAdStr (const String& text, const String& rootPath);
+
+    /** the site-relative path ("dir/name.html") and title of a doc which could be linked
+        from the other pages. for random articel. */
+    struct DocLink
+    {
+        ValueTree doc;
+        String path;
+        String title;
+    };
+
+    /** all docs except the menus, in the order of the project tree (its last child first) */
+    static void getDocLinks (const ValueTree& tree, const File& siteDir, Array<DocLink>& docLinks);
+
+    /** an item of the blog list of index.html */
+    struct BlogListItem
+    {
+        String title;           /**< the title and its link */
+        String date;            /**< create and modified date, the links of its dirs */
+        String description;     /**< the thumbnail, description and 'read more' in html */
+    };
+
+    /** this method is for file-list of index.html. arg 2: the relative root path of the list */
+    static const BlogListItem getBlogListItem (const ValueTree& docTree, const String& rootPath);
+
+    /** the docs of each dir (and its sub-dirs) in the order of the blog list */
+    class BlogListings;
+    static BlogListings& getBlogListings();
 
     static void getBookListLinks (const ValueTree& tree,
                                   const bool isRootTree,
@@ -101,11 +150,9 @@ private:
     static const String getBackPrevLevel();
     static const String getToTop();
 
-    static void extractKeywords (const ValueTree& tree, StringArray& arrayToAddTo);
-
-    static void getDocTreeWithKeyword (const ValueTree& tree, 
-                                       const String& keyword, 
-                                       Array<ValueTree>& result);
+    /** the keywords and the docs which use them */
+    class KeywordIndex;
+    static KeywordIndex& getKeywordIndex();
 
     //=================================================================================================
     bool sortByReverse;
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    HtmlTemplate.cpp
+    Created: 16 Oct 2026 6:11:11pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "WdtpHeader.h"
+
+static const char* const tagNames[] =
+{
+    "content", "title", "keywords", "author", "description", "siteRelativeRootPath",
+    "titleOfDir", "siteLogo", "siteMenu", "siteNavi", "siteLink", "backPrevious", "contentTitle",
+    "contentDesc", "createAndModifyTime", "previousAndNext", "ad", "random", "contact", "toTop",
+    "bottomCopyright", "bookList", "blogList"
+};
+
+static_jassert (sizeof (tagNames) / sizeof (tagNames[0]) == HtmlTemplate::headEnd);
+
+//=================================================================================================
+HtmlTemplate::HtmlTemplate (const String& tplStr)
+{
+    for (int i = numTags; --i >= 0; )
+        usedTags[i] = false;
+
+    int index = 0;
+
+    for (int tagStart = tplStr.indexOf ("{{"); tagStart != -1; tagStart = tplStr.indexOf (index, "{{"))
+    {
+        const int tagEnd = tplStr.indexOf (tagStart + 2, "}}");
+
+        if (tagEnd == -1)
+            break;
+
+        const String name (tplStr.substring (tagStart + 2, tagEnd));
+        int tag = -1;
+
+        for (int i = 0; i < headEnd && tag == -1; ++i)
+            if (name == tagNames[i])
+                tag = i;
+
+        if (tag == -1)  // only a '{' of the text ("{{{title}}"...)
+        {
+            addText (tplStr.substring (index, tagStart + 1));
+            index = tagStart + 1;
+            continue;
+        }
+
+        addText (tplStr.substring (index, tagStart));
+
+        Segment segment = { tplStr.substring (tagStart, tagEnd + 2), tag };
+        segments.add (segment);
+        usedTags[tag] = true;
+
+        index = tagEnd + 2;
+    }
+
+    addText (tplStr.substring (index));
+}
+
+//=================================================================================================
+void HtmlTemplate::addText (const String& text)
+{
+    const String& headEndMark ("\n  <title>");
+    int index = 0;
+
+    for (int markIndex = text.indexOf (headEndMark); markIndex != -1;
+         markIndex = text.indexOf (index, headEndMark))
+    {
+        Segment textSegment = { text.substring (index, markIndex + 1), -1 };
+        Segment headEndSegment = { String(), headEnd };
+
+        segments.add (textSegment);
+        segments.add (headEndSegment);
+        usedTags[headEnd] = true;
+
+        index = markIndex + 1;
+    }
+
+    if (index < text.length())
+    {
+        // joined with the text before it (e.g. an unknown tag)
+        if (segments.size() > 0 && segments.getReference (segments.size() - 1).tag == -1)
+        {
+            segments.getReference (segments.size() - 1).text += text.substring (index);
+        }
+        else
+        {
+            Segment textSegment = { text.substring (index), -1 };
+            segments.add (textSegment);
+        }
+    }
+}
+
+//=================================================================================================
+void HtmlTemplate::write (OutputStream& outputStream, const Values& values) const
+{
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        const Segment& segment (segments.getReference (i));
+
+        if (segment.tag != -1 && values.isSet[segment.tag])
+            outputStream.writeText (values.strings[segment.tag], false, false);
+        else
+            outputStream.writeText (segment.text, false, false);
+    }
+}
+
+//=================================================================================================
+class HtmlTemplate::Cache
+{
+public:
+    Cache() { }
+
+    HtmlTemplate::Ptr get (const File& tplFile)
+    {
+        const ScopedLock sl (lock);
+
+        const String& render (FileTreeContainer::projectTree.getProperty ("render").toString());
+
+        if (FileTreeContainer::projectFile != projectFile || render != projectRender)
+        {
+            entries.clear();
+            projectFile = FileTreeContainer::projectFile;
+            projectRender = render;
+        }
+
+        if (!tplFile.existsAsFile())
+            return nullptr;
+
+        const String& path (tplFile.getFullPathName());
+        const int64 modified = tplFile.getLastModificationTime().toMilliseconds();
+        const int64 size = tplFile.getSize();
+
+        if (entries.contains (path))
+        {
+            const Entry entry (entries[path]);
+
+            if (entry.modified == modified && entry.size == size)
+                return entry.tpl;
+        }
+
+        Entry entry;
+        entry.modified = modified;
+        entry.size = size;
+        entry.tpl = new HtmlTemplate (tplFile.loadFileAsString());
+        entries.set (path, entry);
+
+        return entry.tpl;
+    }
+
+private:
+    struct Entry
+    {
+        int64 modified;
+        int64 size;
+        HtmlTemplate::Ptr tpl;
+    };
+
+    HashMap<String, Entry> entries;
+    File projectFile;
+    String projectRender;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (Cache)
+};
+
+//=================================================================================================
+HtmlTemplate::Cache& HtmlTemplate::getCache()
+{
+    static Cache cache;
+    return cache;
+}
+
+HtmlTemplate::Ptr HtmlTemplate::getTemplate (const File& tplFile)
+{
+    return getCache().get (tplFile);
+}
+
+//=================================================================================================
+HtmlTemplate::Values::Values()
+{
+    for (int i = numTags; --i >= 0; )
+        isSet[i] = false;
+}
+
+void HtmlTemplate::Values::set (const Tag tag, const String& value)
+{
+    strings[tag] = value;
+    isSet[tag] = true;
+}
+
+void HtmlTemplate::Values::append (const Tag tag, const String& value)
+{
+    strings[tag] += value;
+    isSet[tag] = true;
+}
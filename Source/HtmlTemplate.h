@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    HtmlTemplate.h
+    Created: 16 Oct 2026 6:11:11pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef HTMLTEMPLATE_H_INCLUDED
+#define HTMLTEMPLATE_H_INCLUDED
+
+/** A template file (themes/xxx/article.html...) which has been split into its literal text
+    and its tags ({{content}}, {{siteMenu}}...) once. A page is written in one pass: the text
+    and the values of the tags one after another, the template is never searched or copied.
+
+    The end of the head ("\n  <title>") is a tag too (headEnd), the styles and scripts which
+    a page needs are inserted there. An unknown tag ({{xxx}}) is only text.
+
+    Use getTemplate() for the template files, each of them is only read and compiled once.
+*/
+class HtmlTemplate  : public ReferenceCountedObject
+{
+public:
+    typedef ReferenceCountedObjectPtr<HtmlTemplate> Ptr;
+
+    enum Tag
+    {
+        content = 0, title, keywords, author, description, siteRelativeRootPath,
+        titleOfDir, siteLogo, siteMenu, siteNavi, siteLink, backPrevious, contentTitle,
+        contentDesc, createAndModifyTime, previousAndNext, ad, random, contact, toTop,
+        bottomCopyright, bookList, blogList, headEnd,
+
+        numTags
+    };
+
+    /** the text of a template file */
+    explicit HtmlTemplate (const String& tplStr);
+
+    /** The compiled template of a file in the themes of the project, nullptr if there's no
+        such file. A file is only read again when its modified time or size has changed, and
+        all of them are forgotten when another project is opened or the "render" (themes dir)
+        of the project is changed. */
+    static Ptr getTemplate (const File& tplFile);
+
+    const bool isEmpty() const noexcept                 { return segments.size() == 0; }
+    const bool uses (const Tag tag) const noexcept      { return usedTags[tag]; }
+
+    //=================================================================================================
+    /** The values of the tags of a page. A tag which hasn't been given a value is written as
+        it is in the template ("{{bookList}}" of an article...), except headEnd. */
+    class Values
+    {
+    public:
+        Values();
+
+        void set (const Tag tag, const String& value);
+        void append (const Tag tag, const String& value);
+
+    private:
+        friend class HtmlTemplate;
+
+        String strings[numTags];
+        bool isSet[numTags];
+
+        JUCE_DECLARE_NON_COPYABLE (Values)
+    };
+
+    /** Write the page as text (the same as File::appendText() does). */
+    void write (OutputStream& outputStream, const Values& values) const;
+
+private:
+    //=================================================================================================
+    struct Segment
+    {
+        String text;        /**< the literal text, or the tag itself ("{{siteMenu}}") */
+        int tag;            /**< -1 for the literal text */
+    };
+
+    void addText (const String& text);
+
+    /** the compiled templates keyed by their path */
+    class Cache;
+    static Cache& getCache();
+
+    Array<Segment> segments;
+    bool usedTags[numTags];
+
+    JUCE_DECLARE_NON_COPYABLE (HtmlTemplate)
+};
+
+
+#endif  // HTMLTEMPLATE_H_INCLUDED
@@ -105,6 +105,16 @@ void MarkdownEditor::addPopupMenuItems (PopupMenu& menu, const MouseEvent* e)
         menu.addItem (searchPrev, TRANS ("Search Prev Selection") + "  Shift + F3", getHighlightedText().isNotEmpty());
         menu.addSeparator();
 
+        updateOutline();
+        PopupMenu outlineMenu;
+
+        for (int i = 0; i < outline.size(); ++i)
+            outlineMenu.addItem (outlineHeading + i, String::repeatedString ("    ", outline[i].level - 1)
+                                 + outline[i].text);
+
+        menu.addSubMenu (TRANS ("Outline"), outlineMenu, outline.size() > 0);
+        menu.addSeparator();
+
         TextEditor::addPopupMenuItems (menu, e);
         menu.addSeparator();
 
@@ -175,6 +185,9 @@ void MarkdownEditor::performPopupMenuAction (int index)
     else if (setBackground == index)        setBackgroundColour();
     else if (resetDefault == index)         resetToDefault();
 
+    else if (index >= outlineHeading && index < outlineHeading + outline.size())
+        setCaretPosition (outline[index - outlineHeading].position);
+
     else
         TextEditor::performPopupMenuAction (index);
 }
@@ -307,8 +320,7 @@ void MarkdownEditor::interLinkInsert()
                            + File::separatorString);
     linkPath = linkPath.fromFirstOccurrenceOf (siteRoot, false, false);
 
-    const String currentHtmlRelativeToRoot (HtmlProcessor::getRelativePathToRoot (
-        DocTreeViewItem::getHtmlFileOrDir (parent->getCurrentTree())));
+    const String currentHtmlRelativeToRoot (ProjectNodeTable::getRootRelativePath (parent->getCurrentTree()));
 
     String content;
     content << "[" << titleStr << "](" << currentHtmlRelativeToRoot << linkPath.replace ("\\", "/") << ")";
@@ -1198,3 +1210,9 @@ void MarkdownEditor::searchBySelectNext()
     LookAndFeel::getDefaultLookAndFeel().playAlertSound();
 }
 
+
+//=================================================================================================
+void MarkdownEditor::updateOutline()
+{
+    outline = Md2Html::getHeadings (getText(), Md2Html::Options(), &outlineCache);
+}
@@ -60,7 +60,8 @@ private:
         formatBold, formatItalic, formatBoldAndItalic, formatHighlight,
         codeBlock, inlineCode,
         searchNext, searchPrev,
-        fontSize, fontColor, setBackground, resetDefault
+        fontSize, fontColor, setBackground, resetDefault,
+        outlineHeading      // the first heading of the outline, the others follow it
     };
 
     /** for click to select/unselect a keyword from keywords-table component.
@@ -107,6 +108,9 @@ private:
 
     const bool puncMatchingForChinese (const KeyPress& key);
 
+    /** the outline of the current text. only the changed blocks are parsed again */
+    void updateOutline();
+
     //=============================================================================================
     EditAndPreview* parent;
     Slider fontSizeSlider;
@@ -114,6 +118,9 @@ private:
     ScopedPointer<ColourSelectorWithPreset> bgColourSelector;
     String selectedForPunc;
 
+    Array<Md2Html::Heading> outline;
+    Md2Html::BlockCache outlineCache;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MarkdownEditor)
 };
 
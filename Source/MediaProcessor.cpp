@@ -0,0 +1,714 @@
+/*
+  ==============================================================================
+
+    MediaProcessor.cpp
+    Created: 16 Oct 2026 5:50:53pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "WdtpHeader.h"
+
+const int MediaProcessor::variantWidths[3] = { 480, 960, 1600 };
+
+//=================================================================================================
+/** Kept in "cache/imageSizes" of the project dir (a gzipped ValueTree), so the images which
+    haven't been changed since the last generation won't be opened again. The key is the path
+    relative to the project dir, an entry is only used when the modified time and the size of
+    the file are the same as when it was read.
+
+    The content-hash is only needed (and read) for the images which have smaller copies. A
+    photo which is rotated by its exif orientation has none (JUCE decodes it unrotated).
+
+    It also knows the smaller copies which are being written by the VariantJobs, so two pages
+    which use the same image (e.g. the docs of a dir share its media dir) never resize it
+    twice at the same time: the second one only waits for the copy of the first one.
+
+    The copies in "cache/imageVariants" of an image which has been changed are removed, and
+    the ones which no image has any more (e.g. it has been removed) when the cache is loaded. */
+class MediaProcessor::ImageSizes
+{
+public:
+    ImageSizes() : changed (false) { }
+
+    /** the hash is empty if the image is too narrow to have any smaller copy */
+    const bool getSize (const File& imageFile, int& width, int& height, String& hash)
+    {
+        const ScopedLock sl (lock);
+        loadIfNeeded();
+
+        const int64 modified = imageFile.getLastModificationTime().toMilliseconds();
+        const int64 size = imageFile.getSize();
+
+        if (size == 0)
+            return false;
+
+        const String key (imageFile.getRelativePathFrom (projectDir).replaceCharacter ('\\', '/'));
+        Entry entry;
+
+        if (entries.contains (key))
+            entry = entries[key];
+
+        if (entry.modified != modified || entry.size != size)
+        {
+            const String oldHash (entry.hash);
+
+            // a file which isn't an image is kept too (0 x 0), it won't be opened again either
+            entry.modified = modified;
+            entry.size = size;
+            entry.hash = String();
+
+            bool isRotated = false;
+
+            if (!readImageSize (imageFile, entry.width, entry.height, &isRotated))
+                entry.width = entry.height = 0;
+
+            if (entry.width > variantWidths[0] && !isRotated)
+                entry.hash = getContentHash (imageFile);
+
+            entries.set (key, entry);
+            changed = true;
+
+            if (oldHash.isNotEmpty() && oldHash != entry.hash)
+                removeCachedVariants (oldHash);
+        }
+
+        width = entry.width;
+        height = entry.height;
+        hash = entry.hash;
+
+        return width > 0;
+    }
+
+    /** Return true if the copy in the cache hasn't been queued, the caller should write it.
+        Either way, the copy will be copied to the site file once it has been written. */
+    const bool queueVariant (const File& cachedFile, const File& siteFile)
+    {
+        const ScopedLock sl (lock);
+
+        const String key (cachedFile.getFullPathName());
+        const bool isQueued = pendingVariants.contains (key);
+        StringArray siteFiles (pendingVariants[key]);
+
+        siteFiles.addIfNotAlreadyThere (siteFile.getFullPathName());
+        pendingVariants.set (key, siteFiles);
+
+        return !isQueued;
+    }
+
+    /** the copy in the cache has been written (or couldn't be), give it to the site files */
+    void finishVariant (const File& cachedFile, const bool written)
+    {
+        const ScopedLock sl (lock);
+
+        const String key (cachedFile.getFullPathName());
+        const StringArray siteFiles (pendingVariants[key]);
+
+        for (int i = 0; written && i < siteFiles.size(); ++i)
+            cachedFile.copyFileTo (File (siteFiles[i]));
+
+        pendingVariants.remove (key);
+
+        if (pendingVariants.size() == 0)
+            variantsFinished.signal();
+    }
+
+    /** until all the queued copies have been written */
+    void waitForVariants()
+    {
+        for (;;)
+        {
+            {
+                const ScopedLock sl (lock);
+
+                if (pendingVariants.size() == 0)
+                    return;
+            }
+
+            variantsFinished.wait();
+        }
+    }
+
+    /** "cache" of the project dir */
+    const File getCacheDir()
+    {
+        const ScopedLock sl (lock);
+        loadIfNeeded();
+
+        return cacheFile.getParentDirectory();
+    }
+
+    void save()
+    {
+        const ScopedLock sl (lock);
+
+        if (!changed || cacheFile == File::nonexistent)
+            return;
+
+        ValueTree tree ("imageSizes");
+
+        for (HashMap<String, Entry>::Iterator i (entries); i.next(); )
+        {
+            const Entry entry (i.getValue());
+            ValueTree image ("image");
+
+            image.setProperty ("path", i.getKey(), nullptr);
+            image.setProperty ("modified", entry.modified, nullptr);
+            image.setProperty ("size", entry.size, nullptr);
+            image.setProperty ("width", entry.width, nullptr);
+            image.setProperty ("height", entry.height, nullptr);
+            image.setProperty ("hash", entry.hash, nullptr);
+
+            tree.addChild (image, -1, nullptr);
+        }
+
+        cacheFile.getParentDirectory().createDirectory();
+
+        if (SwingUtilities::writeValueTreeToFile (tree, cacheFile, true))
+            changed = false;
+    }
+
+private:
+    struct Entry
+    {
+        Entry() : modified (0), size (0), width (0), height (0) { }
+
+        int64 modified, size;
+        int width, height;
+        String hash;
+    };
+
+    /** 64-bit FNV-1a of the whole file, as 16 hex digits */
+    static const String getContentHash (const File& file)
+    {
+        FileInputStream input (file);
+        HeapBlock<uint8> buffer (64 * 1024);
+        uint64 hash = 14695981039346656037ULL;
+
+        if (!input.openedOk())
+            return String();
+
+        for (int numRead = input.read (buffer, 64 * 1024); numRead > 0; numRead = input.read (buffer, 64 * 1024))
+        {
+            for (int i = 0; i < numRead; ++i)
+                hash = (hash ^ buffer[i]) * 1099511628211ULL;
+        }
+
+        return String::toHexString ((int64)hash).paddedLeft ('0', 16);
+    }
+
+    const File getVariantsDir() const
+    {
+        return cacheFile.getSiblingFile ("imageVariants");
+    }
+
+    /** the copies of an image in the cache, unless another image has the same content */
+    void removeCachedVariants (const String& hash)
+    {
+        for (HashMap<String, Entry>::Iterator i (entries); i.next(); )
+        {
+            if (i.getValue().hash == hash)
+                return;
+        }
+
+        Array<File> cachedFiles;
+        getVariantsDir().findChildFiles (cachedFiles, File::findFiles, false, hash + "-*");
+
+        for (int i = cachedFiles.size(); --i >= 0; )
+        {
+            if (!pendingVariants.contains (cachedFiles.getReference (i).getFullPathName()))
+                cachedFiles.getReference (i).deleteFile();
+        }
+    }
+
+    /** (re)load the cache when it's the first time or another project has been opened */
+    void loadIfNeeded()
+    {
+        if (loadedProject == FileTreeContainer::projectFile)
+            return;
+
+        save();
+        entries.clear();
+
+        loadedProject = FileTreeContainer::projectFile;
+        projectDir = loadedProject.getParentDirectory();
+        cacheFile = (loadedProject == File::nonexistent) ? File::nonexistent
+                    : projectDir.getChildFile ("cache").getChildFile ("imageSizes");
+
+        if (!cacheFile.existsAsFile())
+            return;
+
+        const ValueTree tree (SwingUtilities::readValueTreeFromFile (cacheFile, true));
+        HashMap<String, bool> hashes;
+
+        for (int i = 0; i < tree.getNumChildren(); ++i)
+        {
+            const ValueTree image (tree.getChild (i));
+            const String path (image.getProperty ("path").toString());
+            Entry entry;
+
+            // the images which have been removed since
+            if (!projectDir.getChildFile (path).existsAsFile())
+            {
+                changed = true;
+                continue;
+            }
+
+            entry.modified = (int64)image.getProperty ("modified");
+            entry.size = (int64)image.getProperty ("size");
+            entry.width = (int)image.getProperty ("width");
+            entry.height = (int)image.getProperty ("height");
+            entry.hash = image.getProperty ("hash").toString();
+
+            entries.set (path, entry);
+            hashes.set (entry.hash, true);
+        }
+
+        // the copies which no image has any more, "[hash]-480w.jpg"
+        Array<File> cachedFiles;
+        getVariantsDir().findChildFiles (cachedFiles, File::findFiles, false, "*");
+
+        for (int i = cachedFiles.size(); --i >= 0; )
+        {
+            const File& cachedFile (cachedFiles.getReference (i));
+
+            if (!hashes.contains (cachedFile.getFileName().upToFirstOccurrenceOf ("-", false, false)))
+                cachedFile.deleteFile();
+        }
+    }
+
+    HashMap<String, Entry> entries;
+
+    // the copies in the cache which are being written, and the site files which wait for them
+    HashMap<String, StringArray> pendingVariants;
+    WaitableEvent variantsFinished;
+
+    File loadedProject;
+    File projectDir;
+    File cacheFile;
+    bool changed;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (ImageSizes)
+};
+
+//=================================================================================================
+/** Decodes the image once and writes all its smaller copies which aren't in the cache yet
+    ("cache/imageVariants/[hash]-480w.jpg"), then copies them to the media dirs of the htmls
+    which have been waiting for them.
+    The copies are named by the content-hash of the image, so an existing copy is always the
+    copy of the same image, a changed image gets new ones, and cleaning the site doesn't
+    make them being resized again. */
+class MediaProcessor::VariantJob : public ThreadPoolJob
+{
+public:
+    VariantJob (const File& imageFile_, const Array<File>& cachedFiles_, const Array<int>& widths_)
+        : ThreadPoolJob ("Image variants"),
+          imageFile (imageFile_),
+          cachedFiles (cachedFiles_),
+          widths (widths_)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        const Image image (ImageFileFormat::loadFrom (imageFile));
+
+        // from the widest one, each copy is scaled down from the last one. every queued copy
+        // must be finished, even the ones which couldn't be written
+        Image source (image);
+
+        for (int i = widths.size(); --i >= 0; )
+        {
+            const bool written = image.isValid() && !shouldExit()
+                                 && writeVariant (image, source, widths.getUnchecked (i), cachedFiles[i]);
+
+            getImageSizes().finishVariant (cachedFiles[i], written);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    /** scale the source down to the width and write it into the cache */
+    const bool writeVariant (const Image& image, Image& source, const int width, const File& cachedFile) const
+    {
+        const int height = jmax (1, roundToInt (image.getHeight() * width / (double)image.getWidth()));
+        source = source.rescaled (width, height, Graphics::highResamplingQuality);
+
+        TemporaryFile tempFile (cachedFile);
+        ScopedPointer<FileOutputStream> out (tempFile.getFile().createOutputStream());
+
+        if (out == nullptr)
+            return false;
+
+        PNGImageFormat png;
+        JPEGImageFormat jpeg;
+        jpeg.setQuality (0.85f);
+
+        bool written = imageFile.hasFileExtension ("png") ? png.writeImageToStream (source, *out)
+                                                          : jpeg.writeImageToStream (source, *out);
+        out->flush();
+        written = written && out->getStatus().wasOk();
+        out = nullptr;
+
+        return written && tempFile.overwriteTargetFileWithTemporary();
+    }
+
+    const File imageFile;
+    const Array<File> cachedFiles;
+    const Array<int> widths;
+
+    JUCE_DECLARE_NON_COPYABLE (VariantJob)
+};
+
+//=================================================================================================
+MediaProcessor::ImageSizes& MediaProcessor::getImageSizes()
+{
+    static ImageSizes imageSizes;
+    return imageSizes;
+}
+
+//=================================================================================================
+ThreadPool& MediaProcessor::getVariantPool()
+{
+    // a decoded camera photo is about 100 MB, so not too many of them at the same time
+    static ThreadPool pool (jlimit (1, 4, SystemStats::getNumCpus() - 1));
+    return pool;
+}
+
+//=================================================================================================
+void MediaProcessor::finishImages()
+{
+    getImageSizes().waitForVariants();
+    getImageSizes().save();
+}
+
+//=================================================================================================
+const String MediaProcessor::getVariantFileName (const File& imageFile, const String& hash, const int width)
+{
+    return imageFile.getFileNameWithoutExtension() + "-" + String (width) + "w-"
+        + hash.substring (0, 8) + imageFile.getFileExtension().toLowerCase();
+}
+
+//=================================================================================================
+void MediaProcessor::pruneVariants (const File& mediaDir, const File& htmlMediaDir)
+{
+    if (!htmlMediaDir.isDirectory())
+        return;
+
+    Array<File> siteFiles;
+    htmlMediaDir.findChildFiles (siteFiles, File::findFiles, false, "*-*w-*");
+
+    for (int i = siteFiles.size(); --i >= 0; )
+    {
+        const File& siteFile (siteFiles.getReference (i));
+
+        // a media file of the doc itself, which only looks like a copy
+        if (mediaDir.getChildFile (siteFile.getFileName()).existsAsFile())
+            continue;
+
+        // "xxx-480w-[hash].jpg", see getVariantFileName()
+        const String name (siteFile.getFileNameWithoutExtension());
+        const String hash (name.fromLastOccurrenceOf ("-", false, false));
+        const String nameAndWidth (name.upToLastOccurrenceOf ("-", false, false));
+        const String imageName (nameAndWidth.upToLastOccurrenceOf ("-", false, false));
+        const int variantWidth = nameAndWidth.fromLastOccurrenceOf ("-", false, false).getIntValue();
+        bool isVariant = false;
+
+        for (int j = 0; j < numElementsInArray (variantWidths); ++j)
+            isVariant = isVariant || (variantWidth == variantWidths[j]);
+
+        if (!isVariant || hash.length() != 8 || !hash.containsOnly ("0123456789abcdef")
+            || !nameAndWidth.containsChar ('-')
+            || nameAndWidth.fromLastOccurrenceOf ("-", false, false) != String (variantWidth) + "w")
+            continue;
+
+        // it's still the copy of its image when the image would be given the same one now
+        Array<File> imageFiles;
+        mediaDir.findChildFiles (imageFiles, File::findFiles, false, imageName + ".*");
+        bool isCurrent = false;
+
+        for (int j = 0; j < imageFiles.size() && !isCurrent; ++j)
+        {
+            const File& imageFile (imageFiles.getReference (j));
+            int width = 0, height = 0;
+            String imageHash;
+
+            isCurrent = getImageSizes().getSize (imageFile, width, height, imageHash)
+                        && imageHash.isNotEmpty() && variantWidth < width
+                        && getVariantFileName (imageFile, imageHash, variantWidth) == siteFile.getFileName();
+        }
+
+        if (!isCurrent)
+            siteFile.deleteFile();
+    }
+}
+
+//=================================================================================================
+const String MediaProcessor::addImageAttributes (const String& htmlStr, const File& mdFile,
+                                                 const File& htmlFile)
+{
+    const File mediaDir (mdFile.getSiblingFile ("media"));
+    const File htmlMediaDir (htmlFile.getSiblingFile ("media"));
+
+    // the copies of the images which have been changed or removed since
+    pruneVariants (mediaDir, htmlMediaDir);
+
+    const char* const html = htmlStr.toRawUTF8();
+    const char* const imgTag = "<img src=\"";
+
+    if (strstr (html, imgTag) == nullptr)
+        return htmlStr;
+
+    MemoryOutputStream result (htmlStr.getNumBytesAsUTF8() + 1024);
+    const char* written = html;
+    int numImages = 0;
+
+    for (const char* tag = strstr (html, imgTag); tag != nullptr; tag = strstr (written, imgTag))
+    {
+        const char* const srcStart = tag + strlen (imgTag);
+        const char* const srcEnd = strchr (srcStart, '"');
+
+        if (srcEnd == nullptr)
+            break;
+
+        result.write (written, (size_t) (srcEnd + 1 - written));
+        written = srcEnd + 1;
+
+        // the rest of the tag, the attributes which have been there won't be written twice
+        const char* tagEnd = strchr (written, '>');
+        const String restOfTag (tagEnd == nullptr ? String() : String::fromUTF8 (written, (int) (tagEnd - written)));
+
+        // "media/xxx.jpg", the same as copyDocMediasToSite() copies
+        const String src (String::fromUTF8 (srcStart, (int) (srcEnd - srcStart)));
+        const File imageFile (mediaDir.getChildFile (src.substring (6)));
+        int width = 0, height = 0;
+        String hash;
+
+        if (src.startsWith ("media/")
+            && !src.substring (6).containsAnyOf ("/\\")
+            && !restOfTag.contains ("width=")
+            && getImageSizes().getSize (imageFile, width, height, hash))
+        {
+            result << " width=\"" << width << "\" height=\"" << height << "\"";
+
+            // the smaller copies, the missing ones are written on the worker threads
+            if (hash.isNotEmpty() && imageFile.hasFileExtension ("jpg;jpeg;png")
+                && !restOfTag.contains ("srcset="))
+            {
+                const File variantsDir (getImageSizes().getCacheDir().getChildFile ("imageVariants"));
+                Array<File> cachedFiles;
+                Array<int> missingWidths;
+                String srcset;
+
+                htmlMediaDir.createDirectory();
+                variantsDir.createDirectory();
+
+                for (int i = 0; i < numElementsInArray (variantWidths) && variantWidths[i] < width; ++i)
+                {
+                    const String variantName (getVariantFileName (imageFile, hash, variantWidths[i]));
+                    const File siteFile (htmlMediaDir.getChildFile (variantName));
+                    const File cachedFile (variantsDir.getChildFile (hash + "-" + String (variantWidths[i]) + "w"
+                                                                     + imageFile.getFileExtension().toLowerCase()));
+
+                    srcset << "media/" << variantName << " " << variantWidths[i] << "w, ";
+
+                    if (siteFile.existsAsFile())
+                        continue;
+
+                    // another page which uses the same image may have queued the copy already,
+                    // then it's only copied here when it has been written
+                    if ((!cachedFile.existsAsFile() || !cachedFile.copyFileTo (siteFile))
+                        && getImageSizes().queueVariant (cachedFile, siteFile))
+                    {
+                        cachedFiles.add (cachedFile);
+                        missingWidths.add (variantWidths[i]);
+                    }
+                }
+
+                if (missingWidths.size() > 0)
+                    getVariantPool().addJob (new VariantJob (imageFile, cachedFiles, missingWidths), true);
+
+                // the content of the page is at most 708px wide (style.css)
+                result << " srcset=\"" << srcset << src << " " << width << "w\""
+                       << " sizes=\"(max-width: 708px) 100vw, 708px\"";
+            }
+        }
+
+        if (++numImages > 1 && !restOfTag.contains ("loading="))
+            result << " loading=\"lazy\" decoding=\"async\"";
+    }
+
+    result << written;
+    return result.toUTF8();
+}
+
+//=================================================================================================
+/** the size of a jpeg is in its SOFn segment, which could be after a large exif segment.
+    a photo which is rotated by its exif orientation is given the size after rotated. */
+static const bool readJpegSize (FileInputStream& input, int& width, int& height, bool& isRotated)
+{
+    bool isTransposed = false;
+    int64 position = 2;
+
+    while (input.setPosition (position) && !input.isExhausted())
+    {
+        if ((uint8)input.readByte() != 0xff)
+            return false;
+
+        uint8 marker = (uint8)input.readByte();
+
+        while (marker == 0xff && !input.isExhausted())
+            marker = (uint8)input.readByte();
+
+        // the markers without a length
+        if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd8))
+        {
+            position = input.getPosition();
+            continue;
+        }
+
+        // the image data or its end, there's no SOFn before it
+        if (marker == 0xd9 || marker == 0xda)
+            return false;
+
+        const int length = (uint16)input.readShortBigEndian();
+
+        if (length < 2)
+            return false;
+
+        const int64 segmentEnd = input.getPosition() + length - 2;
+
+        // SOF0 ~ SOF15, except DHT, JPG and DAC
+        if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+        {
+            input.readByte();  // precision
+            height = (uint16)input.readShortBigEndian();
+            width = (uint16)input.readShortBigEndian();
+
+            if (isTransposed)
+                std::swap (width, height);
+
+            return width > 0 && height > 0;
+        }
+
+        // APP1: "Exif\0\0", then a TIFF header and the first IFD, the orientation is 0x0112
+        if (marker == 0xe1 && length > 16)
+        {
+            MemoryBlock exif;
+
+            if (input.readIntoMemoryBlock (exif, jmin (length - 2, 64 * 1024)) > 14
+                && memcmp (exif.getData(), "Exif\0\0", 6) == 0)
+            {
+                const uint8* const tiff = static_cast<const uint8*> (exif.getData()) + 6;
+                const int tiffSize = (int)exif.getSize() - 6;
+                const bool isLittleEndian = (tiff[0] == 'I');
+
+                const int ifd = isLittleEndian ? (int)ByteOrder::littleEndianInt (tiff + 4)
+                                               : (int)ByteOrder::bigEndianInt (tiff + 4);
+
+                if (ifd > 0 && ifd + 2 <= tiffSize)
+                {
+                    const int numEntries = isLittleEndian ? ByteOrder::littleEndianShort (tiff + ifd)
+                                                          : ByteOrder::bigEndianShort (tiff + ifd);
+
+                    for (int i = 0; i < numEntries && ifd + 2 + (i + 1) * 12 <= tiffSize; ++i)
+                    {
+                        const uint8* const entry = tiff + ifd + 2 + i * 12;
+                        const uint16 tagId = isLittleEndian ? ByteOrder::littleEndianShort (entry)
+                                                            : ByteOrder::bigEndianShort (entry);
+
+                        if (tagId == 0x0112)
+                        {
+                            const uint16 orientation = isLittleEndian ? ByteOrder::littleEndianShort (entry + 8)
+                                                                      : ByteOrder::bigEndianShort (entry + 8);
+
+                            // 2 ~ 8: flipped or rotated, 5 ~ 8: transposed or rotated by 90 degrees
+                            isRotated = (orientation >= 2 && orientation <= 8);
+                            isTransposed = (orientation >= 5 && orientation <= 8);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        position = segmentEnd;
+    }
+
+    return false;
+}
+
+//=================================================================================================
+const bool MediaProcessor::readImageSize (const File& imageFile, int& width, int& height,
+                                          bool* isRotated)
+{
+    bool isJpegRotated = false;
+
+    FileInputStream input (imageFile);
+
+    if (!input.openedOk())
+        return false;
+
+    uint8 header[32] = { 0 };
+    const int headerSize = input.read (header, (int)sizeof (header));
+
+    width = height = 0;
+
+    if (headerSize >= 24 && memcmp (header, "\x89PNG\r\n\x1a\n", 8) == 0)
+    {
+        // IHDR is always the first chunk
+        width = (int)ByteOrder::bigEndianInt (header + 16);
+        height = (int)ByteOrder::bigEndianInt (header + 20);
+    }
+    else if (headerSize >= 10 && memcmp (header, "GIF8", 4) == 0)
+    {
+        width = ByteOrder::littleEndianShort (header + 6);
+        height = ByteOrder::littleEndianShort (header + 8);
+    }
+    else if (headerSize >= 4 && header[0] == 0xff && header[1] == 0xd8 && header[2] == 0xff)
+    {
+        const bool isJpeg = readJpegSize (input, width, height, isJpegRotated);
+
+        if (isRotated != nullptr)
+            *isRotated = isJpegRotated;
+
+        return isJpeg;
+    }
+    else if (headerSize >= 26 && header[0] == 'B' && header[1] == 'M')
+    {
+        // BITMAPCOREHEADER (12 bytes) has 16-bit sizes, the others have 32-bit ones
+        if (ByteOrder::littleEndianInt (header + 14) == 12)
+        {
+            width = ByteOrder::littleEndianShort (header + 18);
+            height = ByteOrder::littleEndianShort (header + 20);
+        }
+        else
+        {
+            width = (int)ByteOrder::littleEndianInt (header + 18);
+            height = std::abs ((int)ByteOrder::littleEndianInt (header + 22));  // negative: top-down
+        }
+    }
+    else if (headerSize >= 30 && memcmp (header, "RIFF", 4) == 0 && memcmp (header + 8, "WEBP", 4) == 0)
+    {
+        if (memcmp (header + 12, "VP8 ", 4) == 0)
+        {
+            width = ByteOrder::littleEndianShort (header + 26) & 0x3fff;
+            height = ByteOrder::littleEndianShort (header + 28) & 0x3fff;
+        }
+        else if (memcmp (header + 12, "VP8L", 4) == 0 && header[20] == 0x2f)
+        {
+            width = 1 + (header[21] | ((header[22] & 0x3f) << 8));
+            height = 1 + ((header[22] >> 6) | (header[23] << 2) | ((header[24] & 0x0f) << 10));
+        }
+        else if (memcmp (header + 12, "VP8X", 4) == 0)
+        {
+            width = 1 + (header[24] | (header[25] << 8) | (header[26] << 16));
+            height = 1 + (header[27] | (header[28] << 8) | (header[29] << 16));
+        }
+    }
+
+    return width > 0 && height > 0;
+}
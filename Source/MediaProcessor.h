@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    MediaProcessor.h
+    Created: 16 Oct 2026 5:50:53pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef MEDIAPROCESSOR_H_INCLUDED
+#define MEDIAPROCESSOR_H_INCLUDED
+
+/** The images of the docs (in the "media" dir beside a doc) when the site is generated */
+struct MediaProcessor
+{
+    /** Give each <img> of the html the width and height of its image in the media dir of the
+        md-file, so the page won't reflow while the images are being loaded. The images after
+        the first one (which are likely below the first screen) are also loaded lazily and
+        decoded asynchronously. The sizes come from the image-size cache of the project.
+
+        A large jpeg or png is also given a srcset of its smaller copies (see variantWidths),
+        which are written into the media dir of the html-file on the worker threads. The old
+        copies there, of the images which have been changed or removed, are removed. */
+    static const String addImageAttributes (const String& htmlStr, const File& mdFile,
+                                            const File& htmlFile);
+
+    /** Read the width and height from the header of a png, jpeg, gif, bmp or webp file.
+        Return false if it isn't one of them (or it's broken). A jpeg photo which is rotated
+        (or flipped) by its exif orientation is given the size after rotated (isRotated). */
+    static const bool readImageSize (const File& imageFile, int& width, int& height,
+                                     bool* isRotated = nullptr);
+
+    /** Wait for the smaller copies of the images which are still being written, then write
+        the image-size cache of the project to disk if it has been changed. It'll be called
+        whenever the project is saved, that is, after the htmls have been generated. */
+    static void finishImages();
+
+    /** The widths of the smaller copies, "xxx-480w-[hash].jpg" ... An image only has the
+        copies which are narrower than itself. They're kept in "cache/imageVariants" of the
+        project dir too, so they won't be resized again after the site has been cleaned. */
+    static const int variantWidths[3];
+
+private:
+    /** the width, height and content-hash of the images keyed by their path, modified time
+        and size */
+    class ImageSizes;
+    static ImageSizes& getImageSizes();
+
+    /** writes the smaller copies of an image */
+    class VariantJob;
+    static ThreadPool& getVariantPool();
+
+    static const String getVariantFileName (const File& imageFile, const String& hash, const int width);
+
+    /** remove the smaller copies in the media dir of the html whose image has been changed or
+        removed from the media dir of the doc, or is too narrow to have them now */
+    static void pruneVariants (const File& mediaDir, const File& htmlMediaDir);
+
+};
+
+
+#endif  // MEDIAPROCESSOR_H_INCLUDED
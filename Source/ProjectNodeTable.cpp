@@ -0,0 +1,300 @@
+/*
+  ==============================================================================
+
+    ProjectNodeTable.cpp
+    Created: 16 Oct 2026 6:23:30pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "WdtpHeader.h"
+
+//=================================================================================================
+/** A ValueTree can't be hashed, so each tree of the project is stamped with its row, then the
+    tree of that row is compared. A copy of a tree, or a removed one, could still have a row
+    which isn't its own. The rows of the removed trees are only marked, the table is made again
+    when there're too many of them. */
+class ProjectNodeTable::Table  : private ProjectCache
+{
+public:
+    struct Node
+    {
+        ValueTree tree;         /**< invalid if it has been removed */
+        int parent;             /**< the row of its parent, -1 for the project */
+        int depth;              /**< 0 for the project */
+        bool isDoc;
+        String name;
+        File mdFile;
+        File htmlFile;
+        String rootPath;
+    };
+
+    Table()  : numRemoved (0)
+    {
+        rebuild();
+    }
+
+    /** false if the tree isn't in the project, only the field asked for is copied, e.g.
+        find (tree, &Node::mdFile, file) */
+    template <typename FieldType>
+    const bool find (const ValueTree& tree, FieldType Node::* field, FieldType& result)
+    {
+        const ScopedLock sl (lock);
+        const int row = findRow (tree);
+
+        if (row == -1)
+            return false;
+
+        result = nodes.getReference (row).*field;
+        return true;
+    }
+
+private:
+    //=============================================================================================
+    const int findRow (const ValueTree& tree) const
+    {
+        const int row = tree.getProperty (rowProperty, -1);
+
+        if (isPositiveAndBelow (row, nodes.size()) && nodes.getReference (row).tree == tree)
+            return row;
+
+        return -1;
+    }
+
+    //=============================================================================================
+    void rebuild()
+    {
+        nodes.clearQuick();
+        numRemoved = 0;
+        projectFile = FileTreeContainer::projectFile;
+
+        if (FileTreeContainer::projectTree.isValid())
+            addNodes (FileTreeContainer::projectTree, -1);
+    }
+
+    /** the tree and all the trees in it */
+    void addNodes (const ValueTree& tree, const int parentRow)
+    {
+        Node node;
+        node.tree = tree;
+        node.parent = parentRow;
+        node.isDoc = (tree.getType().toString() == "doc");
+        node.name = tree.getProperty ("name").toString();
+
+        if (parentRow == -1)
+        {
+            node.depth = 0;
+            node.mdFile = projectFile.getSiblingFile ("docs");
+            node.htmlFile = projectFile.getSiblingFile ("site").getChildFile ("index.html");
+        }
+        else
+        {
+            const Node& parentNode (nodes.getReference (parentRow));
+            node.depth = parentNode.depth + 1;
+
+            if (node.isDoc)
+            {
+                node.mdFile = parentNode.mdFile.getChildFile (node.name + ".md");
+                node.htmlFile = parentNode.htmlFile.getSiblingFile (node.name + ".html");
+                node.rootPath = parentNode.rootPath;
+            }
+            else
+            {
+                node.mdFile = parentNode.mdFile.getChildFile (node.name);
+                node.htmlFile = parentNode.htmlFile.getSiblingFile (node.name).getChildFile ("index.html");
+                node.rootPath = parentNode.rootPath + "../";
+            }
+        }
+
+        const int row = nodes.size();
+        nodes.add (node);
+
+        // not told to the caches, see FileTreeContainer::ProjectListener
+        if ((int) tree.getProperty (rowProperty, -1) != row)
+            ValueTree (tree).setProperty (rowProperty, row, nullptr);
+
+        for (int i = 0; i < tree.getNumChildren(); ++i)
+            addNodes (tree.getChild (i), row);
+    }
+
+    void removeRow (const int row)
+    {
+        nodes.getReference (row).tree = ValueTree();
+        ++numRemoved;
+    }
+
+    /** the trees in it, which still have their rows */
+    void removeChildRows (const ValueTree& tree)
+    {
+        for (int i = tree.getNumChildren(); --i >= 0; )
+        {
+            const ValueTree child (tree.getChild (i));
+            const int row = findRow (child);
+
+            if (row != -1)
+                removeRow (row);
+
+            removeChildRows (child);
+        }
+    }
+
+    void compactIfNeeded()
+    {
+        if (numRemoved > 64 && numRemoved > nodes.size() / 2)
+            rebuild();
+    }
+
+    //=============================================================================================
+    void propertyChanged (const ValueTree& tree, const Identifier& property) override
+    {
+        if (tree.getType().toString() == "wdtpProject" || property != Identifier ("name"))
+            return;
+
+        const ScopedLock sl (lock);
+        const int row = findRow (tree);
+
+        if (row == -1)
+            return;
+
+        // a renamed dir: the paths of all the docs and dirs in it have been changed
+        const int parentRow = nodes.getReference (row).parent;
+
+        removeRow (row);
+        removeChildRows (tree);
+        addNodes (tree, parentRow);
+        compactIfNeeded();
+    }
+
+    void treeAdded (const ValueTree& parentTree, const ValueTree& tree) override
+    {
+        const ScopedLock sl (lock);
+        const int parentRow = findRow (parentTree);
+
+        if (parentRow != -1)
+            addNodes (tree, parentRow);
+    }
+
+    void treeRemoved (const ValueTree&, const ValueTree& tree) override
+    {
+        const ScopedLock sl (lock);
+        const int row = findRow (tree);
+
+        if (row != -1)
+            removeRow (row);
+
+        removeChildRows (tree);
+        compactIfNeeded();
+    }
+
+    void projectChanged() override
+    {
+        const ScopedLock sl (lock);
+        rebuild();
+    }
+
+    //=============================================================================================
+    Array<Node> nodes;
+    int numRemoved;
+    File projectFile;
+    CriticalSection lock;
+
+    static const Identifier rowProperty;
+
+    JUCE_DECLARE_NON_COPYABLE (Table)
+};
+
+const Identifier ProjectNodeTable::Table::rowProperty ("nodeTableRow");
+
+//=================================================================================================
+ProjectNodeTable::Table& ProjectNodeTable::getTable()
+{
+    static Table table;
+    return table;
+}
+
+//=================================================================================================
+const File ProjectNodeTable::getMdFileOrDir (const ValueTree& tree)
+{
+    if (!tree.isValid())
+        return File::nonexistent;
+
+    File mdFile;
+
+    if (getTable().find (tree, &Table::Node::mdFile, mdFile))
+        return mdFile;
+
+    // not in the project
+    const File& root (FileTreeContainer::projectFile.getSiblingFile ("docs"));
+
+    if (tree.getType().toString() == "wdtpProject")
+        return root;
+
+    String path = tree.getProperty ("name").toString();
+    ValueTree t (tree);
+
+    while (t.getParent().isValid() && t.getParent().getType().toString() != "wdtpProject")
+    {
+        t = t.getParent();
+        path = t.getProperty ("name").toString() + File::separator + path;
+    }
+
+    if (tree.getType().toString() == "doc")
+        path += ".md";
+
+    return root.getChildFile (path);
+}
+
+//=================================================================================================
+const File ProjectNodeTable::getHtmlFile (const ValueTree& tree)
+{
+    File htmlFile;
+
+    if (getTable().find (tree, &Table::Node::htmlFile, htmlFile))
+        return htmlFile;
+
+    // not in the project
+    const File siteFileOrDir (getSiteFileOrDir (getMdFileOrDir (tree)));
+
+    if (siteFileOrDir == File::nonexistent)
+        return File::nonexistent;
+
+    if (tree.getType().toString() == "doc")
+        return siteFileOrDir.withFileExtension ("html");
+
+    return siteFileOrDir.getChildFile ("index.html");
+}
+
+//=================================================================================================
+const String ProjectNodeTable::getRootRelativePath (const ValueTree& tree)
+{
+    String rootPath;
+
+    if (getTable().find (tree, &Table::Node::rootPath, rootPath))
+        return rootPath;
+
+    // not in the project
+    if (tree.getType().toString() == "dir")
+        rootPath << "../";
+
+    for (ValueTree t (tree.getParent()); t.isValid() && t.getType().toString() != "wdtpProject"; t = t.getParent())
+        rootPath << "../";
+
+    return rootPath;
+}
+
+//=================================================================================================
+const File ProjectNodeTable::getSiteFileOrDir (const File& docsFileOrDir)
+{
+    const File docsDir (FileTreeContainer::projectFile.getSiblingFile ("docs"));
+    const File siteDir (FileTreeContainer::projectFile.getSiblingFile ("site"));
+
+    if (docsFileOrDir == docsDir)
+        return siteDir;
+
+    // only the files in "docs" have their same ones in "site"
+    if (!docsFileOrDir.isAChildOf (docsDir))
+        return File::nonexistent;
+
+    return siteDir.getChildFile (docsFileOrDir.getRelativePathFrom (docsDir));
+}
@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    ProjectNodeTable.h
+    Created: 16 Oct 2026 6:23:30pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef PROJECTNODETABLE_H_INCLUDED
+#define PROJECTNODETABLE_H_INCLUDED
+
+/** The docs and dirs of the project in a flat table: the parent, type, name and depth of each
+    of them, its md file (or dir), its html file and the relative path from the html to the root
+    of the site. The table is made once for a project, then kept up to date when a doc or dir
+    is added, removed, moved or renamed, so the paths of a doc or dir don't need to walk its
+    parents and join their names any more. Each doc and dir is stamped with its row
+    (the "nodeTableRow" property, which is only read by the table), so it's found at once.
+
+    A tree which isn't in the project (e.g. a copy of a dir) is worked out from its parents. */
+class ProjectNodeTable
+{
+public:
+    /** the md file of a doc, the dir in "docs" of a dir, "docs" itself of the project.
+        a nonexistent file when the arg is invalid. */
+    static const File getMdFileOrDir (const ValueTree& tree);
+
+    /** the html file of a doc, the index.html of a dir (and of the project).
+        a nonexistent file when the arg is invalid. */
+    static const File getHtmlFile (const ValueTree& tree);
+
+    /** the relative path from its html file to the root of the site ("", "../", "../../"...),
+        the end character is '/' */
+    static const String getRootRelativePath (const ValueTree& tree);
+
+    /** the same file or dir in "site" of a file or dir in "docs" (the extension isn't changed).
+        a nonexistent file when it isn't in "docs" (it used to replace "docs" with "site"
+        anywhere in the path). */
+    static const File getSiteFileOrDir (const File& docsFileOrDir);
+
+private:
+    class Table;
+    static Table& getTable();
+
+};
+
+
+#endif  // PROJECTNODETABLE_H_INCLUDED
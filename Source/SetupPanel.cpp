@@ -54,6 +54,8 @@ void SetupPanel::showProjectProperties (ValueTree& pTree)
     values[projectJs]->setValue (pTree.getProperty ("js"));
     values[ad]->setValue (pTree.getProperty ("ad"));
     values[contact]->setValue (pTree.getProperty ("contact"));
+    values[minify]->setValue (pTree.getProperty ("minify"));
+    values[gzip]->setValue (pTree.getProperty ("gzip"));
 
     Array<PropertyComponent*> projectProperties;
 
@@ -110,6 +112,8 @@ void SetupPanel::showProjectProperties (ValueTree& pTree)
     projectProperties.add (new TextPropertyComponent (*values[copyrightInfo], TRANS ("Copyright: "), 0, true));
     projectProperties.add (new TextPropertyComponent (Value (pTree.getProperty ("modifyDate")), 
                                                       TRANS ("Last Modified: "), 0, false));
+    projectProperties.add (new BooleanPropertyComponent (*values[minify], TRANS ("Minify Output: "), TRANS ("Yes")));
+    projectProperties.add (new BooleanPropertyComponent (*values[gzip], TRANS ("Gzip Copies: "), TRANS ("Yes")));
 
     for (auto p : projectProperties)  
         p->setPreferredHeight (28);
@@ -371,6 +375,12 @@ void SetupPanel::valueChanged (Value& value)
     else if (value.refersToSameSourceAs (*values[contact]))
         currentTree.setProperty ("contact", values[contact]->getValue(), nullptr);
 
+    else if (value.refersToSameSourceAs (*values[minify]))
+        currentTree.setProperty ("minify", values[minify]->getValue(), nullptr);
+
+    else if (value.refersToSameSourceAs (*values[gzip]))
+        currentTree.setProperty ("gzip", values[gzip]->getValue(), nullptr);
+
     // dir properties
     else if (value.refersToSameSourceAs (*values[dirTitle]))
         currentTree.setProperty ("title", values[dirTitle]->getValue(), nullptr);
@@ -0,0 +1,1150 @@
+/*
+  ==============================================================================
+
+    CodeHighlighter.cpp
+    Created: 16 Oct 2026 5:47:49pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "JuceHeader.h"
+#include "CodeHighlighter.h"
+
+//=================================================================================================
+// the words of the languages, sorted by their bytes (they're searched by binary search)
+
+static const char* const cppKeywords[] =
+{
+    "abstract", "alignas", "alignof", "asm", "auto", "bool", "boolean", "break", "byte", "case",
+    "catch", "char", "char16_t", "char32_t", "class", "const", "const_cast", "constexpr",
+    "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+    "explicit", "export", "extends", "extern", "final", "float", "for", "foreach", "friend",
+    "goto", "if", "implements", "import", "in", "inline", "instanceof", "int", "int16", "int32",
+    "int64", "int8", "interface", "is", "lock", "long", "mutable", "namespace", "new",
+    "noexcept", "object", "operator", "out", "override", "package", "private", "protected",
+    "public", "readonly", "ref", "register", "reinterpret_cast", "return", "sealed", "short",
+    "signed", "size_t", "sizeof", "static", "static_assert", "static_cast", "struct",
+    "super", "switch", "synchronized", "template", "this", "thread_local", "throw", "throws",
+    "transient", "try", "typedef", "typeid", "typename", "uint", "uint16", "uint32", "uint64",
+    "uint8", "union", "unsigned", "using", "var", "virtual", "void", "volatile", "wchar_t",
+    "while"
+};
+
+static const char* const cppLiterals[] =
+{
+    "NULL", "false", "nullptr", "true"
+};
+
+static const char* const cppBuiltIns[] =
+{
+    "abs", "array", "calloc", "cerr", "cin", "clog", "cout", "deque", "endl", "fprintf", "free",
+    "list", "make_shared", "make_unique", "malloc", "map", "max", "memcmp", "memcpy", "memmove",
+    "memset", "min", "move", "pair", "printf", "puts", "queue", "realloc", "scanf", "set",
+    "shared_ptr", "snprintf", "sprintf", "stack", "std", "strcat", "strcmp", "strcpy", "string",
+    "strlen", "swap", "unique_ptr", "vector", "weak_ptr", "wstring"
+};
+
+static const char* const jsKeywords[] =
+{
+    "as", "async", "await", "break", "case", "catch", "class", "const", "continue", "debugger",
+    "default", "delete", "do", "else", "export", "extends", "finally", "for", "from",
+    "function", "get", "if", "import", "in", "instanceof", "let", "new", "of", "return", "set",
+    "static", "super", "switch", "this", "throw", "try", "typeof", "var", "void", "while",
+    "with", "yield"
+};
+
+static const char* const jsLiterals[] =
+{
+    "Infinity", "NaN", "false", "null", "true", "undefined"
+};
+
+static const char* const jsBuiltIns[] =
+{
+    "Array", "Boolean", "Date", "Error", "JSON", "Map", "Math", "Number", "Object", "Promise",
+    "RegExp", "Set", "String", "Symbol", "alert", "clearInterval", "clearTimeout", "console",
+    "document", "exports", "isNaN", "module", "parseFloat", "parseInt", "require",
+    "setInterval", "setTimeout", "window"
+};
+
+static const char* const pythonKeywords[] =
+{
+    "and", "as", "assert", "async", "await", "break", "class", "continue", "def", "del", "elif",
+    "else", "except", "exec", "finally", "for", "from", "global", "if", "import", "in", "is",
+    "lambda", "nonlocal", "not", "or", "pass", "print", "raise", "return", "try", "while",
+    "with", "yield"
+};
+
+static const char* const pythonLiterals[] =
+{
+    "Ellipsis", "False", "None", "NotImplemented", "True"
+};
+
+static const char* const pythonBuiltIns[] =
+{
+    "abs", "all", "any", "bin", "bool", "bytes", "callable", "chr", "cls", "dict", "dir",
+    "divmod", "enumerate", "eval", "filter", "float", "format", "frozenset", "getattr",
+    "globals", "hasattr", "hash", "help", "hex", "id", "input", "int", "isinstance",
+    "issubclass", "iter", "len", "list", "locals", "map", "max", "min", "next", "object", "oct",
+    "open", "ord", "pow", "property", "range", "repr", "reversed", "round", "self", "set",
+    "setattr", "slice", "sorted", "staticmethod", "str", "sum", "super", "tuple", "type",
+    "vars", "zip"
+};
+
+static const char* const shellKeywords[] =
+{
+    "break", "case", "continue", "declare", "do", "done", "elif", "else", "esac", "export",
+    "fi", "for", "function", "if", "in", "local", "readonly", "return", "select", "shift",
+    "then", "unset", "until", "while"
+};
+
+static const char* const shellBuiltIns[] =
+{
+    "alias", "apt", "apt-get", "awk", "brew", "cat", "cd", "chmod", "chown", "clang", "cmake",
+    "cp", "curl", "dpkg", "echo", "egrep", "eval", "exec", "exit", "find", "gcc", "git", "grep",
+    "head", "kill", "ln", "ls", "make", "man", "mkdir", "mv", "node", "npm", "pip", "pip3",
+    "printf", "ps", "pwd", "python", "python3", "read", "rm", "rmdir", "scp", "sed", "service",
+    "set", "sort", "source", "ssh", "su", "sudo", "systemctl", "tail", "tar", "test", "touch",
+    "uniq", "unzip", "wc", "wget", "which", "xargs", "yarn", "yum", "zip"
+};
+
+//=================================================================================================
+/** Scans the code once and adds its tokens. Each language is a small state machine over the
+    bytes, they share the helpers which find the end of a word, string, number or line. A '\'
+    and the char after it are always skipped together, so no token begins at an escaped char.
+*/
+class CodeHighlighter::Tokenizer
+{
+public:
+    Tokenizer (const char* code_, const int size_, Array<Token>& tokens_)
+        : code (code_), size (size_), tokens (tokens_)
+    {
+    }
+
+    void tokenize (const Language language, const int start, const int end)
+    {
+        switch (language)
+        {
+            case cpp:           tokenizeCLike (start, end, true); break;
+            case javascript:    tokenizeCLike (start, end, false); break;
+            case python:        tokenizePython (start, end); break;
+            case shell:         tokenizeShell (start, end); break;
+            case json:          tokenizeJson (start, end); break;
+            case xml:           tokenizeXml (start, end); break;
+            case css:           tokenizeCss (start, end); break;
+            default:            break;
+        }
+    }
+
+private:
+    //=============================================================================================
+    void tokenizeCLike (const int start, const int end, const bool isCpp)
+    {
+        // the name after "class", "function"... is its title
+        bool isDeclaration = false;
+
+        for (int i = start; i < end; )
+        {
+            const char c = code[i];
+
+            if (c == '\\')
+            {
+                i += 2;
+            }
+            else if (c == '/' && charAt (i + 1) == '/')
+            {
+                i = add (i, getLineEnd (i, end), comment);
+            }
+            else if (c == '/' && charAt (i + 1) == '*')
+            {
+                i = add (i, getEndOf (i + 2, end, "*/"), comment);
+            }
+            else if (isCpp && c == '#' && isLineStart (start, i))
+            {
+                i = add (i, getLineEnd (i, end), meta);
+            }
+            else if (c == '"' || c == '\'' || (!isCpp && c == '`'))
+            {
+                i = add (i, getStringEnd (i, end, c == '`'), string);
+            }
+            else if (isNumberStart (i))
+            {
+                i = add (i, getNumberEnd (i, end), number);
+            }
+            else if (isWordStart (c) || (!isCpp && c == '$'))
+            {
+                const int wordEnd = getWordEnd (i, end, isCpp ? "" : "$");
+                const TokenType type = isCpp ? getWordType (i, wordEnd, cppKeywords, cppLiterals, cppBuiltIns)
+                                             : getWordType (i, wordEnd, jsKeywords, jsLiterals, jsBuiltIns);
+
+                if (type != (TokenType) numTypes)
+                    add (i, wordEnd, type);
+                else if (isDeclaration)
+                    add (i, wordEnd, title);
+
+                isDeclaration = isWord (i, wordEnd, "class") || isWord (i, wordEnd, "struct")
+                             || isWord (i, wordEnd, "enum") || isWord (i, wordEnd, "namespace")
+                             || isWord (i, wordEnd, "function");
+                i = wordEnd;
+            }
+            else
+            {
+                isDeclaration = isDeclaration && isSpace (c);
+                ++i;
+            }
+        }
+    }
+
+    //=============================================================================================
+    void tokenizePython (const int start, const int end)
+    {
+        bool isDeclaration = false;
+
+        for (int i = start; i < end; )
+        {
+            const char c = code[i];
+
+            if (c == '\\')
+            {
+                i += 2;
+            }
+            else if (c == '#')
+            {
+                i = add (i, getLineEnd (i, end), comment);
+            }
+            else if (c == '@' && isLineStart (start, i) && isWordStart (charAt (i + 1)))
+            {
+                i = add (i, getWordEnd (i + 1, end, "."), meta);
+            }
+            else if (c == '"' || c == '\'')
+            {
+                i = add (i, getPythonStringEnd (i, end), string);
+            }
+            else if (isNumberStart (i))
+            {
+                i = add (i, getNumberEnd (i, end), number);
+            }
+            else if (isWordStart (c))
+            {
+                const int wordEnd = getWordEnd (i, end, "");
+
+                // r"", b'', f"""..."""
+                if (wordEnd - i <= 2 && isStringPrefix (i, wordEnd)
+                     && (code[wordEnd] == '"' || code[wordEnd] == '\''))
+                {
+                    i = add (i, getPythonStringEnd (wordEnd, end), string);
+                    continue;
+                }
+
+                const TokenType type = getWordType (i, wordEnd, pythonKeywords, pythonLiterals, pythonBuiltIns);
+
+                if (type != (TokenType) numTypes)
+                    add (i, wordEnd, type);
+                else if (isDeclaration)
+                    add (i, wordEnd, title);
+
+                isDeclaration = isWord (i, wordEnd, "def") || isWord (i, wordEnd, "class");
+                i = wordEnd;
+            }
+            else
+            {
+                isDeclaration = isDeclaration && isSpace (c);
+                ++i;
+            }
+        }
+    }
+
+    //=============================================================================================
+    void tokenizeShell (const int start, const int end)
+    {
+        for (int i = start; i < end; )
+        {
+            const char c = code[i];
+
+            if (c == '\\')
+            {
+                i += 2;
+            }
+            else if (c == '#' && (i == start || isSpace (code[i - 1]) || code[i - 1] == ';'))
+            {
+                i = add (i, getLineEnd (i, end), (charAt (i + 1) == '!' && isBlank (start, i)) ? meta : comment);
+            }
+            else if (c == '\'')
+            {
+                // no escape inside '...'
+                i = add (i, getEndOf (i + 1, end, "'"), string);
+            }
+            else if (c == '"')
+            {
+                i = add (i, getStringEnd (i, end, true), string);
+            }
+            else if (c == '$' && charAt (i + 1) == '{')
+            {
+                i = add (i, getEndOf (i + 2, end, "}"), variable);
+            }
+            else if (c == '$' && (isWordChar (charAt (i + 1)) || (charAt (i + 1) != 0 && strchr ("@*#?$!-", charAt (i + 1)) != nullptr)))
+            {
+                i = add (i, isWordChar (charAt (i + 1)) ? getWordEnd (i + 1, end, "") : i + 2, variable);
+            }
+            else if (isWordChar (c) && !isWordChar (charAt (i - 1)) && charAt (i - 1) != '-'
+                     && charAt (i - 1) != '.' && charAt (i - 1) != '/')
+            {
+                const int wordEnd = getWordEnd (i, end, "-.");
+
+                if (charAt (wordEnd) == '/')
+                    i = wordEnd;
+                else if (isDigits (i, wordEnd))
+                    i = add (i, wordEnd, number);
+                else if (isIn (shellKeywords, numElementsInArray (shellKeywords), i, wordEnd))
+                    i = add (i, wordEnd, keyword);
+                else if (isIn (shellBuiltIns, numElementsInArray (shellBuiltIns), i, wordEnd))
+                    i = add (i, wordEnd, builtIn);
+                else
+                    i = wordEnd;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    //=============================================================================================
+    void tokenizeJson (const int start, const int end)
+    {
+        for (int i = start; i < end; )
+        {
+            const char c = code[i];
+
+            if (c == '"')
+            {
+                const int stringEnd = getStringEnd (i, end, false);
+                int next = stringEnd;
+
+                while (next < end && isSpace (code[next]))
+                    ++next;
+
+                i = add (i, stringEnd, charAt (next) == ':' ? attr : string);
+            }
+            else if (isNumberStart (i) || (c == '-' && isDigit (charAt (i + 1))))
+            {
+                i = add (i, getNumberEnd (i + 1, end), number);
+            }
+            else if (isWordStart (c))
+            {
+                const int wordEnd = getWordEnd (i, end, "");
+
+                if (isWord (i, wordEnd, "true") || isWord (i, wordEnd, "false") || isWord (i, wordEnd, "null"))
+                    add (i, wordEnd, literal);
+
+                i = wordEnd;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    //=============================================================================================
+    void tokenizeXml (const int start, const int end)
+    {
+        for (int i = start; i < end; )
+        {
+            if (startsWith (i, end, "<!--"))
+            {
+                i = add (i, getEndOf (i + 4, end, "-->"), comment);
+            }
+            else if (startsWith (i, end, "<![CDATA["))
+            {
+                i = getEndOf (i + 9, end, "]]>");
+            }
+            else if (startsWith (i, end, "<!") || startsWith (i, end, "<?"))
+            {
+                i = add (i, getEndOf (i + 2, end, ">"), meta);
+            }
+            else if (code[i] == '<' && (isWordStart (charAt (i + 1)) || (charAt (i + 1) == '/' && isWordStart (charAt (i + 2)))))
+            {
+                const bool isEndTag = (code[i + 1] == '/');
+                const int nameStart = add (i, i + (isEndTag ? 2 : 1), tag);
+                const int nameEnd = add (nameStart, getWordEnd (nameStart, end, ":-."), name);
+
+                i = tokenizeAttributes (nameEnd, end);
+
+                // the script and the style inside the html
+                if (!isEndTag && (isWordIgnoreCase (nameStart, nameEnd, "script") || isWordIgnoreCase (nameStart, nameEnd, "style")))
+                {
+                    const bool isScript = isWordIgnoreCase (nameStart, nameEnd, "script");
+                    const int innerEnd = getIndexIgnoreCase (i, end, isScript ? "</script" : "</style");
+
+                    tokenize (isScript ? javascript : css, i, innerEnd);
+                    i = innerEnd;
+                }
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    /** the attributes of a tag and its '>', return the end of the tag */
+    const int tokenizeAttributes (int i, const int end)
+    {
+        while (i < end)
+        {
+            const char c = code[i];
+
+            if (c == '>' || (c == '/' && charAt (i + 1) == '>'))
+            {
+                return add (i, i + (c == '>' ? 1 : 2), tag);
+            }
+            else if (c == '"' || c == '\'')
+            {
+                i = add (i, getEndOf (i + 1, end, c == '"' ? "\"" : "'"), string);
+            }
+            else if (c == '=')
+            {
+                int value = i + 1;
+
+                while (value < end && isSpace (code[value]))
+                    ++value;
+
+                // unquoted value
+                if (value < end && code[value] != '"' && code[value] != '\'' && code[value] != '>')
+                {
+                    int valueEnd = value;
+
+                    while (valueEnd < end && !isSpace (code[valueEnd]) && code[valueEnd] != '>')
+                        ++valueEnd;
+
+                    add (value, valueEnd, string);
+                    i = valueEnd;
+                }
+                else
+                {
+                    i = value;
+                }
+            }
+            else if (isWordStart (c))
+            {
+                i = add (i, getWordEnd (i, end, ":-."), attr);
+            }
+            else if (c == '<')
+            {
+                return i;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        return end;
+    }
+
+    //=============================================================================================
+    void tokenizeCss (const int start, const int end)
+    {
+        // a selector until '{', or a property until ';' or '}'
+        bool isStatementStart = true, isSelector = true, isValue = false;
+
+        for (int i = start; i < end; )
+        {
+            const char c = code[i];
+
+            if (isStatementStart && !isSpace (c))
+            {
+                isSelector = (charAt (getStatementEnd (i, end)) == '{');
+                isValue = false;
+                isStatementStart = false;
+            }
+
+            if (c == '\\')
+            {
+                i += 2;
+            }
+            else if (c == '/' && charAt (i + 1) == '*')
+            {
+                i = add (i, getEndOf (i + 2, end, "*/"), comment);
+                isStatementStart = true;
+            }
+            else if (c == '"' || c == '\'')
+            {
+                i = add (i, getStringEnd (i, end, false), string);
+            }
+            else if (c == '{' || c == '}' || c == ';')
+            {
+                isStatementStart = true;
+                ++i;
+            }
+            else if (c == '@' && isWordStart (charAt (i + 1)))
+            {
+                i = add (i, getWordEnd (i + 1, end, "-"), keyword);
+            }
+            else if (isSelector)
+            {
+                if ((c == '.' || c == '#') && isCssWordStart (charAt (i + 1)))
+                    i = add (i, getWordEnd (i + 1, end, "-"), c == '.' ? selectorClass : selectorId);
+                else if (c == ':' || c == '[')
+                    i = skipCssWord (i + 1, end);
+                else if (isCssWordStart (c))
+                    i = add (i, getWordEnd (i, end, "-"), selectorTag);
+                else
+                    ++i;
+            }
+            else if (!isValue)
+            {
+                if (isCssWordStart (c))
+                {
+                    i = add (i, getWordEnd (i, end, "-"), attribute);
+                }
+                else
+                {
+                    isValue = (c == ':');
+                    ++i;
+                }
+            }
+            else
+            {
+                if (isNumberStart (i) || (c == '#' && isWordChar (charAt (i + 1))))
+                    i = add (i, getNumberEnd (i + 1, end, "%"), number);
+                else if (c == '!' && isWordStart (charAt (i + 1)))
+                    i = add (i, getWordEnd (i + 1, end, ""), keyword);
+                else if (isCssWordStart (c))
+                    i = getWordEnd (i, end, "-");
+                else
+                    ++i;
+            }
+        }
+    }
+
+    /** the index of the '{', ';' or '}' which ends the statement, or the end */
+    const int getStatementEnd (int i, const int end) const noexcept
+    {
+        for (; i < end; ++i)
+        {
+            if (code[i] == '{' || code[i] == ';' || code[i] == '}')
+                return i;
+
+            if (code[i] == '"' || code[i] == '\'')
+                i = getStringEnd (i, end, false) - 1;
+        }
+
+        return end;
+    }
+
+    const int skipCssWord (int i, const int end) const noexcept
+    {
+        while (i < end && (isCssWordStart (code[i]) || code[i] == ':'))
+            i = getWordEnd (i, end, "-") + (code[i] == ':' ? 1 : 0);
+
+        return i;
+    }
+
+    //=============================================================================================
+    /** return the end */
+    const int add (const int start, const int end, const TokenType type)
+    {
+        if (end > start)
+        {
+            Token token;
+            token.start = start;
+            token.end = end;
+            token.type = type;
+
+            tokens.add (token);
+        }
+
+        return end;
+    }
+
+    /** return 0 if the index is out of the code */
+    const char charAt (const int index) const noexcept
+    {
+        return isPositiveAndBelow (index, size) ? code[index] : 0;
+    }
+
+    static const bool isSpace (const char c) noexcept        { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+    static const bool isDigit (const char c) noexcept        { return c >= '0' && c <= '9'; }
+    static const bool isWordStart (const char c) noexcept    { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (c & 0x80) != 0; }
+    static const bool isWordChar (const char c) noexcept     { return isWordStart (c) || isDigit (c); }
+    static const bool isCssWordStart (const char c) noexcept { return isWordStart (c) || c == '-' || c == '*'; }
+    static const char toLowerAscii (const char c) noexcept   { return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c; }
+
+    const bool isNumberStart (const int i) const noexcept
+    {
+        return (isDigit (code[i]) || (code[i] == '.' && isDigit (charAt (i + 1)))) && !isWordChar (charAt (i - 1));
+    }
+
+    /** only ' ' and '\t' before it in its line */
+    const bool isLineStart (const int start, int i) const noexcept
+    {
+        while (i > start && (code[i - 1] == ' ' || code[i - 1] == '\t'))
+            --i;
+
+        return i == start || code[i - 1] == '\n' || code[i - 1] == '\r';
+    }
+
+    const bool startsWith (const int i, const int end, const char* target) const noexcept
+    {
+        const int length = (int) strlen (target);
+        return i + length <= end && memcmp (code + i, target, (size_t) length) == 0;
+    }
+
+    const bool isWord (const int start, const int end, const char* word) const noexcept
+    {
+        return (int) strlen (word) == end - start && memcmp (code + start, word, (size_t) (end - start)) == 0;
+    }
+
+    const bool isWordIgnoreCase (const int start, const int end, const char* word) const noexcept
+    {
+        return (int) strlen (word) == end - start && getIndexIgnoreCase (start, end, word) == start;
+    }
+
+    const bool isBlank (int start, const int end) const noexcept
+    {
+        for (; start < end; ++start)
+        {
+            if (!isSpace (code[start]))
+                return false;
+        }
+
+        return true;
+    }
+
+    const bool isDigits (int start, const int end) const noexcept
+    {
+        for (; start < end; ++start)
+        {
+            if (!isDigit (code[start]))
+                return false;
+        }
+
+        return true;
+    }
+
+    const bool isStringPrefix (int start, const int end) const noexcept
+    {
+        for (; start < end; ++start)
+        {
+            if (strchr ("rRbBuUfF", code[start]) == nullptr)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** the word chars and the extra ones */
+    const int getWordEnd (int i, const int end, const char* extraChars) const noexcept
+    {
+        while (i < end && (isWordChar (code[i]) || (code[i] != 0 && strchr (extraChars, code[i]) != nullptr)))
+            ++i;
+
+        return i;
+    }
+
+    /** digits, letters ("0x1f", "1.5e-3f", "12px") and the extra ones */
+    const int getNumberEnd (int i, const int end, const char* extraChars = "") const noexcept
+    {
+        while (i < end)
+        {
+            const char c = code[i];
+
+            if (isWordChar (c) || c == '.' || (c != 0 && strchr (extraChars, c) != nullptr))
+                ++i;
+            else if ((c == '+' || c == '-') && (code[i - 1] == 'e' || code[i - 1] == 'E') && isDigit (charAt (i + 1)))
+                i += 2;
+            else
+                break;
+        }
+
+        return i;
+    }
+
+    /** the index of the line break, or the end */
+    const int getLineEnd (int i, const int end) const noexcept
+    {
+        while (i < end && code[i] != '\n' && code[i] != '\r')
+            ++i;
+
+        return i;
+    }
+
+    /** after the target, or the end */
+    const int getEndOf (const int i, const int end, const char* target) const noexcept
+    {
+        const int found = getIndex (i, end, target);
+        return (found != -1) ? found + (int) strlen (target) : end;
+    }
+
+    const int getIndex (int i, const int end, const char* target) const noexcept
+    {
+        for (; i < end; ++i)
+        {
+            if (code[i] == *target && startsWith (i, end, target))
+                return i;
+        }
+
+        return -1;
+    }
+
+    /** the end if it isn't found */
+    const int getIndexIgnoreCase (int i, const int end, const char* target) const noexcept
+    {
+        const int length = (int) strlen (target);
+
+        for (; i + length <= end; ++i)
+        {
+            int n = 0;
+
+            while (n < length && toLowerAscii (code[i + n]) == target[n])
+                ++n;
+
+            if (n == length)
+                return i;
+        }
+
+        return end;
+    }
+
+    /** from the opening quote, the index after the closing one (or the line end, or the end) */
+    const int getStringEnd (int i, const int end, const bool multiLine) const noexcept
+    {
+        const char quote = code[i++];
+
+        while (i < end && code[i] != quote)
+        {
+            if (!multiLine && (code[i] == '\n' || code[i] == '\r'))
+                return i;
+
+            i += (code[i] == '\\') ? 2 : 1;
+        }
+
+        return jmin (i + 1, end);
+    }
+
+    const int getPythonStringEnd (const int i, const int end) const noexcept
+    {
+        const char quote = code[i];
+        const char tripleQuote[] = { quote, quote, quote, 0 };
+
+        if (startsWith (i, end, tripleQuote))
+            return getEndOf (i + 3, end, tripleQuote);
+
+        return getStringEnd (i, end, false);
+    }
+
+    //=============================================================================================
+    /** numTypes if it's none of them */
+    template <int numKeywords, int numLiterals, int numBuiltIns>
+    const TokenType getWordType (const int start, const int end,
+                                 const char* const (&keywords)[numKeywords],
+                                 const char* const (&literals)[numLiterals],
+                                 const char* const (&builtIns)[numBuiltIns]) const noexcept
+    {
+        if (isIn (keywords, numKeywords, start, end))    return keyword;
+        if (isIn (literals, numLiterals, start, end))    return literal;
+        if (isIn (builtIns, numBuiltIns, start, end))    return builtIn;
+
+        return (TokenType) numTypes;
+    }
+
+    const bool isIn (const char* const* words, const int numWords, const int start, const int end) const noexcept
+    {
+        const int length = end - start;
+        int first = 0, last = numWords;
+
+        while (first < last)
+        {
+            const int middle = (first + last) / 2;
+            int result = strncmp (words[middle], code + start, (size_t) length);
+
+            if (result == 0)
+                result = (words[middle][length] == 0) ? 0 : 1;
+
+            if (result == 0)
+                return true;
+
+            if (result < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        return false;
+    }
+
+    //=============================================================================================
+    /** not a type of the tokens, it means "none of them" */
+    enum { numTypes = selectorId + 1 };
+
+    const char* const code;
+    const int size;
+    Array<Token>& tokens;
+
+    JUCE_DECLARE_NON_COPYABLE (Tokenizer)
+};
+
+//=================================================================================================
+/** The tokens of the code which has been highlighted, by the hash of the code. When they're
+    more than maxSize (the bytes of the code), all of them are dropped. */
+class CodeHighlighter::Cache
+{
+public:
+    Cache() : totalSize (0) {}
+
+    /** false if it isn't in the cache */
+    const bool find (const void* code, const int size, Language& language, Array<Token>& tokens) const
+    {
+        const ScopedLock sl (lock);
+        const Entry* const entry = entriesByHash[getHash (code, size)];
+
+        if (entry == nullptr || entry->code.getSize() != (size_t) size
+             || memcmp (entry->code.getData(), code, (size_t) size) != 0)
+            return false;
+
+        language = entry->language;
+        tokens = entry->tokens;
+        return true;
+    }
+
+    void add (const void* code, const int size, const Language language, const Array<Token>& tokens)
+    {
+        if (size > maxSize)
+            return;
+
+        const ScopedLock sl (lock);
+
+        if (totalSize + size > maxSize)
+        {
+            entriesByHash.clear();
+            entries.clear();
+            totalSize = 0;
+        }
+
+        Entry* const entry = entries.add (new Entry());
+        entry->code.replaceWith (code, (size_t) size);
+        entry->language = language;
+        entry->tokens = tokens;
+
+        entriesByHash.set (getHash (code, size), entry);
+        totalSize += size;
+    }
+
+private:
+    enum { maxSize = 4 * 1024 * 1024 };
+
+    struct Entry
+    {
+        MemoryBlock code;
+        Language language;
+        Array<Token> tokens;
+    };
+
+    static const int getHash (const void* code, const int size) noexcept
+    {
+        // FNV-1a
+        const uint8* const data = static_cast<const uint8*> (code);
+        uint32 hash = 2166136261u;
+
+        for (int i = 0; i < size; ++i)
+            hash = (hash ^ data[i]) * 16777619u;
+
+        return (int) (hash & 0x7fffffff);
+    }
+
+    OwnedArray<Entry> entries;
+    HashMap<int, Entry*> entriesByHash;
+    int totalSize;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (Cache)
+};
+
+//=================================================================================================
+const CodeHighlighter::Language CodeHighlighter::highlight (const void* code, const int size,
+                                                           Array<Token>& tokens)
+{
+    static Cache cache;
+    Language language = unknown;
+
+    tokens.clearQuick();
+
+    if (cache.find (code, size, language, tokens))
+        return language;
+
+    language = detectLanguage (code, size);
+
+    Tokenizer tokenizer (static_cast<const char*> (code), size, tokens);
+    tokenizer.tokenize (language, 0, size);
+
+    cache.add (code, size, language, tokens);
+    return language;
+}
+
+//=================================================================================================
+const char* CodeHighlighter::getClassName (const TokenType type) noexcept
+{
+    static const char* const classNames[] =
+    {
+        "hljs-keyword", "hljs-built_in", "hljs-literal", "hljs-number", "hljs-string",
+        "hljs-comment", "hljs-meta", "hljs-title", "hljs-tag", "hljs-name", "hljs-attr",
+        "hljs-attribute", "hljs-variable", "hljs-selector-tag", "hljs-selector-class",
+        "hljs-selector-id"
+    };
+
+    return classNames[type];
+}
+
+//=================================================================================================
+/** The marks of a language and how much they say about it. A language is chosen when its
+    score is at least 3 and higher than all the others. */
+struct LanguageMark
+{
+    CodeHighlighter::Language language;
+    const char* text;
+    int score;
+    bool atLineStart;
+};
+
+static const LanguageMark languageMarks[] =
+{
+    { CodeHighlighter::cpp, "#include", 5, true },          { CodeHighlighter::cpp, "#define", 3, true },
+    { CodeHighlighter::cpp, "#if", 3, true },               { CodeHighlighter::cpp, "#pragma", 3, true },
+    { CodeHighlighter::cpp, "using namespace", 4, true },   { CodeHighlighter::cpp, "template", 2, true },
+    { CodeHighlighter::cpp, "public:", 3, true },           { CodeHighlighter::cpp, "private:", 3, true },
+    { CodeHighlighter::cpp, "std::", 3, false },            { CodeHighlighter::cpp, "::", 1, false },
+    { CodeHighlighter::cpp, "->", 1, false },               { CodeHighlighter::cpp, "nullptr", 3, false },
+    { CodeHighlighter::cpp, "int main", 3, false },         { CodeHighlighter::cpp, "cout", 2, false },
+    { CodeHighlighter::cpp, "void ", 1, false },            { CodeHighlighter::cpp, "printf (", 1, false },
+    { CodeHighlighter::cpp, "printf(", 1, false },          { CodeHighlighter::cpp, "public static", 2, false },
+
+    { CodeHighlighter::javascript, "function", 2, false },  { CodeHighlighter::javascript, "=>", 2, false },
+    { CodeHighlighter::javascript, "===", 3, false },       { CodeHighlighter::javascript, "!==", 3, false },
+    { CodeHighlighter::javascript, "console.", 4, false },  { CodeHighlighter::javascript, "document.", 4, false },
+    { CodeHighlighter::javascript, "window.", 3, false },   { CodeHighlighter::javascript, "undefined", 2, false },
+    { CodeHighlighter::javascript, "require(", 3, false },  { CodeHighlighter::javascript, "var ", 1, true },
+    { CodeHighlighter::javascript, "let ", 2, true },       { CodeHighlighter::javascript, "const ", 1, true },
+
+    { CodeHighlighter::python, "def ", 4, true },           { CodeHighlighter::python, "elif ", 4, true },
+    { CodeHighlighter::python, "from ", 2, true },          { CodeHighlighter::python, "import ", 1, true },
+    { CodeHighlighter::python, "else:", 3, true },          { CodeHighlighter::python, "try:", 3, true },
+    { CodeHighlighter::python, "except", 3, true },         { CodeHighlighter::python, "self.", 3, false },
+    { CodeHighlighter::python, "None", 2, false },          { CodeHighlighter::python, "__init__", 4, false },
+    { CodeHighlighter::python, "print(", 1, false },        { CodeHighlighter::python, "lambda ", 1, false },
+
+    { CodeHighlighter::shell, "$ ", 4, true },              { CodeHighlighter::shell, "sudo ", 4, true },
+    { CodeHighlighter::shell, "apt-get ", 4, true },        { CodeHighlighter::shell, "brew ", 4, true },
+    { CodeHighlighter::shell, "yum ", 4, true },            { CodeHighlighter::shell, "git ", 3, true },
+    { CodeHighlighter::shell, "npm ", 3, true },            { CodeHighlighter::shell, "pip ", 3, true },
+    { CodeHighlighter::shell, "echo ", 2, true },           { CodeHighlighter::shell, "cd ", 2, true },
+    { CodeHighlighter::shell, "export ", 2, true },         { CodeHighlighter::shell, "mkdir ", 2, true },
+    { CodeHighlighter::shell, "chmod ", 2, true },          { CodeHighlighter::shell, "ls ", 2, true },
+    { CodeHighlighter::shell, "; then", 3, false },         { CodeHighlighter::shell, "; do", 2, false },
+    { CodeHighlighter::shell, "esac", 3, true },            { CodeHighlighter::shell, "${", 2, false },
+    { CodeHighlighter::shell, "| grep", 3, false },         { CodeHighlighter::shell, "$HOME", 3, false },
+};
+
+/** the names which could follow the fence of a code-block */
+struct LanguageName
+{
+    const char* name;
+    CodeHighlighter::Language language;
+};
+
+static const LanguageName languageNames[] =
+{
+    { "c", CodeHighlighter::cpp },              { "cpp", CodeHighlighter::cpp },
+    { "c++", CodeHighlighter::cpp },            { "h", CodeHighlighter::cpp },
+    { "hpp", CodeHighlighter::cpp },            { "java", CodeHighlighter::cpp },
+    { "cs", CodeHighlighter::cpp },             { "c#", CodeHighlighter::cpp },
+    { "objc", CodeHighlighter::cpp },           { "objectivec", CodeHighlighter::cpp },
+    { "js", CodeHighlighter::javascript },      { "javascript", CodeHighlighter::javascript },
+    { "py", CodeHighlighter::python },          { "python", CodeHighlighter::python },
+    { "sh", CodeHighlighter::shell },           { "bash", CodeHighlighter::shell },
+    { "shell", CodeHighlighter::shell },        { "console", CodeHighlighter::shell },
+    { "json", CodeHighlighter::json },          { "html", CodeHighlighter::xml },
+    { "xml", CodeHighlighter::xml },            { "css", CodeHighlighter::css }
+};
+
+/** the same mark is counted at most 3 times */
+static const int countMark (const char* code, const int size, const LanguageMark& mark)
+{
+    const int length = (int) strlen (mark.text);
+    int count = 0;
+
+    for (int i = 0; i + length <= size && count < 3; ++i)
+    {
+        if (code[i] != mark.text[0] || memcmp (code + i, mark.text, (size_t) length) != 0)
+            continue;
+
+        if (mark.atLineStart)
+        {
+            int lineStart = i;
+
+            while (lineStart > 0 && (code[lineStart - 1] == ' ' || code[lineStart - 1] == '\t'))
+                --lineStart;
+
+            if (lineStart > 0 && code[lineStart - 1] != '\n' && code[lineStart - 1] != '\r')
+                continue;
+        }
+
+        ++count;
+    }
+
+    return count;
+}
+
+/** only strings, numbers, true, false, null and the punctuation of JSON */
+static const bool isJson (const char* code, const int size)
+{
+    for (int i = 0; i < size; )
+    {
+        const char c = code[i];
+
+        if (c == '"')
+        {
+            for (++i; i < size && code[i] != '"'; i += (code[i] == '\\') ? 2 : 1)
+            {
+                if (code[i] == '\n' || code[i] == '\r')
+                    return false;
+            }
+
+            ++i;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || strchr ("{}[],:-+.eE0123456789", c) != nullptr)
+        {
+            ++i;
+        }
+        else if (i + 4 <= size && (memcmp (code + i, "true", 4) == 0 || memcmp (code + i, "null", 4) == 0))
+        {
+            i += 4;
+        }
+        else if (i + 5 <= size && memcmp (code + i, "false", 5) == 0)
+        {
+            i += 5;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** a declaration like "color: #333;" which begins at i and ends in the same line */
+static const bool isCssProperty (const char* code, int i, const int lineEnd)
+{
+    const int nameStart = i;
+
+    while (i < lineEnd && ((code[i] >= 'a' && code[i] <= 'z') || code[i] == '-'))
+        ++i;
+
+    if (i == nameStart || i >= lineEnd || code[i] != ':')
+        return false;
+
+    while (++i < lineEnd)
+    {
+        if (code[i] == ';' || code[i] == '}')
+            return true;
+    }
+
+    return false;
+}
+
+//=================================================================================================
+const CodeHighlighter::Language CodeHighlighter::detectLanguage (const void* codeData, const int size)
+{
+    const char* const code = static_cast<const char*> (codeData);
+    int first = 0;
+
+    while (first < size && (code[first] == ' ' || code[first] == '\t' || code[first] == '\r' || code[first] == '\n'))
+        ++first;
+
+    if (first == size)
+        return unknown;
+
+    int firstLineEnd = first;
+
+    while (firstLineEnd < size && code[firstLineEnd] != '\n' && code[firstLineEnd] != '\r')
+        ++firstLineEnd;
+
+    const String firstLine (String::fromUTF8 (code + first, firstLineEnd - first).trimEnd().toLowerCase());
+
+    // the name after the fence, e.g. "```cpp"
+    for (int i = 0; i < numElementsInArray (languageNames); ++i)
+    {
+        if (firstLine == languageNames[i].name)
+            return languageNames[i].language;
+    }
+
+    // #!/bin/bash, #!/usr/bin/env python...
+    if (firstLine.startsWith ("#!"))
+    {
+        if (firstLine.contains ("python"))  return python;
+        if (firstLine.contains ("node"))    return javascript;
+        if (firstLine.contains ("sh"))      return shell;
+    }
+
+    if (code[first] == '<')
+        return (size - first > 5 && memcmp (code + first, "<?php", 5) == 0) ? unknown : xml;
+
+    if ((code[first] == '{' || code[first] == '[') && isJson (code + first, size - first))
+        return json;
+
+    int scores[css + 1] = { 0 };
+
+    for (int i = 0; i < numElementsInArray (languageMarks); ++i)
+        scores[languageMarks[i].language] += countMark (code, size, languageMarks[i]) * languageMarks[i].score;
+
+    // CSS is only properties and selectors, without '(' (except url() or rgb()...) and '='
+    int numProperties = 0;
+
+    for (int lineStart = 0; lineStart < size; )
+    {
+        int lineEnd = lineStart;
+
+        while (lineEnd < size && code[lineEnd] != '\n' && code[lineEnd] != '\r')
+            ++lineEnd;
+
+        // at the beginning of the line, or after a '{' or ';' (e.g. "p { margin: 0; }")
+        for (int i = lineStart; i < lineEnd; ++i)
+        {
+            if (i > lineStart && code[i - 1] != '{' && code[i - 1] != ';')
+                continue;
+
+            int start = i;
+
+            while (start < lineEnd && (code[start] == ' ' || code[start] == '\t'))
+                ++start;
+
+            if (isCssProperty (code, start, lineEnd))
+                ++numProperties;
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    if (numProperties > 0 && memchr (code, '{', (size_t) size) != nullptr && memchr (code, '=', (size_t) size) == nullptr)
+        scores[css] = 2 * jmin (numProperties, 3);
+
+    Language best = unknown;
+    bool isTie = false;
+
+    for (int language = cpp; language <= css; ++language)
+    {
+        if (scores[language] > scores[best])
+        {
+            best = (Language) language;
+            isTie = false;
+        }
+        else if (scores[language] == scores[best])
+        {
+            isTie = true;
+        }
+    }
+
+    return (scores[best] >= 3 && !isTie) ? best : unknown;
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    CodeHighlighter.h
+    Created: 16 Oct 2026 5:47:49pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef CODEHIGHLIGHTER_H_INCLUDED
+#define CODEHIGHLIGHTER_H_INCLUDED
+
+/** Highlights the code of a code-block the way highlight.js (add-in/hl.js) does it in the
+    browser and gives the tokens the same class names (hljs-keyword, hljs-string...), so the
+    page of the code which has been highlighted here doesn't need to load and run the script.
+
+    The language is guessed from the code: C/C++ (and the C-like Java, C#...), JavaScript,
+    Python, shell, JSON, HTML/XML and CSS. The code which doesn't look like any of them is
+    left to hl.js.
+
+    The result of a code is kept by its hash, the same code-block (e.g. of the pages which
+    are generated again) isn't scanned twice. It could be used on any thread.
+*/
+struct CodeHighlighter
+{
+    enum Language { unknown = 0, cpp, javascript, python, shell, json, xml, css };
+
+    enum TokenType
+    {
+        keyword = 0, builtIn, literal, number, string, comment, meta, title,
+        tag, name, attr, attribute, variable, selectorTag, selectorClass, selectorId
+    };
+
+    /** a part of the code which is given a span, the positions are byte offsets */
+    struct Token
+    {
+        int start, end;
+        TokenType type;
+    };
+
+    /** The language of the UTF-8 code and its tokens in order (they never overlap, but a
+        multi-line comment or string has the line breaks inside it). Return unknown and
+        give no token for the code of other languages. */
+    static const Language highlight (const void* code, const int size, Array<Token>& tokens);
+
+    static const Language detectLanguage (const void* code, const int size);
+
+    /** "hljs-keyword", "hljs-string"... */
+    static const char* getClassName (const TokenType type) noexcept;
+
+private:
+    class Tokenizer;
+    class Cache;
+};
+
+
+#endif  // CODEHIGHLIGHTER_H_INCLUDED
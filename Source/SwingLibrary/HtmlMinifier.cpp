@@ -0,0 +1,691 @@
+/*
+  ==============================================================================
+
+    HtmlMinifier.cpp
+    Created: 16 Oct 2026 6:05:51pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "JuceHeader.h"
+#include "HtmlMinifier.h"
+
+static const int minifierBufferSize = 8192;
+
+static inline const bool isSpaceChar (const char c) noexcept
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\f';
+}
+
+static inline const bool isTagNameChar (const char c) noexcept
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+        || c == '!' || c == '-' || c == '?' || c == ':' || c == '_';
+}
+
+static inline const bool isIdentifierChar (const char c) noexcept
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+        || c == '_' || c == '$' || (unsigned char) c >= 0x80;
+}
+
+static inline const char toLowerAscii (const char c) noexcept
+{
+    return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c;
+}
+
+static const bool isOneOf (const char* name, const char* const* names, const int numNames) noexcept
+{
+    for (int i = 0; i < numNames; ++i)
+    {
+        const char* a = name;
+        const char* b = names[i];
+
+        while (*b != 0 && toLowerAscii (*a) == *b)
+        {
+            ++a;
+            ++b;
+        }
+
+        if (*a == 0 && *b == 0)
+            return true;
+    }
+
+    return false;
+}
+
+//=================================================================================================
+HtmlMinifier::HtmlMinifier (OutputStream* dest, const bool deleteDestStreamWhenDestroyed)
+    : destStream (dest, deleteDestStreamWhenDestroyed),
+      buffer ((size_t) minifierBufferSize),
+      bufferUsed (0),
+      numBytesIn (0),
+      state (text),
+      pendingSpace (false),
+      afterBlock (true),
+      nameLength (0),
+      isClosingTag (false),
+      isLongName (false),
+      tagPendingSpace (false),
+      quote (0),
+      lastTagChar (0),
+      commentLength (0),
+      keepComment (false),
+      rawEndLength (0),
+      rawMatched (0)
+{
+    jassert (dest != nullptr);
+
+    name[0] = 0;
+    lastTwo[0] = lastTwo[1] = 0;
+}
+
+HtmlMinifier::~HtmlMinifier()
+{
+    // pass on what has been held, the white-spaces at the end are dropped
+    if (state == tagName)
+    {
+        if (!isLongName)
+        {
+            emit ('<');
+
+            if (isClosingTag)
+                emit ('/');
+
+            emit (name, nameLength);
+        }
+    }
+    else if (state == raw)
+    {
+        emit (rawHeld, rawMatched);
+    }
+
+    flush();
+}
+
+//=================================================================================================
+void HtmlMinifier::flush()
+{
+    if (bufferUsed > 0)
+        destStream->write (buffer, (size_t) bufferUsed);
+
+    bufferUsed = 0;
+    destStream->flush();
+}
+
+//=================================================================================================
+bool HtmlMinifier::write (const void* data, size_t numBytes)
+{
+    const char* const chars = static_cast<const char*> (data);
+
+    for (size_t i = 0; i < numBytes; ++i)
+        process (chars[i]);
+
+    numBytesIn += (int64) numBytes;
+    return true;
+}
+
+//=================================================================================================
+void HtmlMinifier::process (const char c)
+{
+    switch (state)
+    {
+        case tagName:   processTagName (c);  return;
+        case tagBody:   processTagBody (c);  return;
+        case comment:   processComment (c);  return;
+        case raw:       processRaw (c);      return;
+        default:        break;
+    }
+
+    if (isSpaceChar (c))
+    {
+        pendingSpace = true;
+    }
+    else if (c == '<')
+    {
+        state = tagName;
+        nameLength = 0;
+        name[0] = 0;
+        isClosingTag = false;
+        isLongName = false;
+    }
+    else
+    {
+        writePending();
+        afterBlock = false;
+        emit (c);
+    }
+}
+
+//=================================================================================================
+void HtmlMinifier::processTagName (const char c)
+{
+    if (isLongName)
+    {
+        if (isTagNameChar (c))
+        {
+            emit (c);
+        }
+        else
+        {
+            state = tagBody;
+            processTagBody (c);
+        }
+
+        return;
+    }
+
+    if (c == '/' && nameLength == 0 && !isClosingTag)
+    {
+        isClosingTag = true;
+        return;
+    }
+
+    // a tag begins with a letter or '!' ('<!doctype', '<!--'), otherwise it's only a '<' of the text
+    const bool isStart = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '!' || c == '?';
+
+    if ((nameLength == 0 && !isStart) || (nameLength > 0 && !isTagNameChar (c)))
+    {
+        if (nameLength == 0)
+        {
+            state = text;
+            writePending();
+            afterBlock = false;
+            emit ('<');
+
+            if (isClosingTag)
+                emit ('/');
+
+            process (c);
+            return;
+        }
+
+        beginTag();
+        state = tagBody;
+        processTagBody (c);
+        return;
+    }
+
+    if (nameLength == numElementsInArray (name) - 1)
+    {
+        // much longer than any block-level tag, so it could be written now
+        beginTag();
+        isLongName = true;
+        emit (c);
+        return;
+    }
+
+    name[nameLength++] = c;
+    name[nameLength] = 0;
+
+    if (nameLength == 3 && !isClosingTag && name[0] == '!' && name[1] == '-' && name[2] == '-')
+    {
+        state = comment;
+        commentLength = 0;
+        keepComment = false;
+    }
+}
+
+//=================================================================================================
+void HtmlMinifier::beginTag()
+{
+    if (isBlockTag (name))
+        pendingSpace = false;
+    else
+        writePending();
+
+    emit ('<');
+
+    if (isClosingTag)
+        emit ('/');
+
+    emit (name, nameLength);
+
+    tagPendingSpace = false;
+    quote = 0;
+    lastTagChar = 0;
+}
+
+//=================================================================================================
+void HtmlMinifier::processTagBody (const char c)
+{
+    if (quote != 0)
+    {
+        emit (c);
+
+        if (c == quote)
+            quote = 0;
+
+        lastTagChar = c;
+    }
+    else if (isSpaceChar (c))
+    {
+        tagPendingSpace = true;
+    }
+    else if (c == '>')
+    {
+        tagPendingSpace = false;
+        emit (c);
+        endTag();
+        lastTagChar = c;
+    }
+    else
+    {
+        // no space around '=', but the one before "/>" is kept
+        if (tagPendingSpace && c != '=' && lastTagChar != '=')
+            emit (' ');
+
+        tagPendingSpace = false;
+
+        if (c == '"' || c == '\'')
+            quote = c;
+
+        emit (c);
+        lastTagChar = c;
+    }
+}
+
+//=================================================================================================
+void HtmlMinifier::endTag()
+{
+    const bool isBlock = !isLongName && isBlockTag (name);
+
+    if (!isLongName && !isClosingTag && lastTagChar != '/' && isRawTag (name))
+    {
+        state = raw;
+        rawMatched = 0;
+        rawEnd[0] = '<';
+        rawEnd[1] = '/';
+
+        for (int i = 0; i < nameLength; ++i)
+            rawEnd[i + 2] = toLowerAscii (name[i]);
+
+        rawEndLength = nameLength + 2;
+    }
+    else
+    {
+        state = text;
+    }
+
+    afterBlock = isBlock;
+}
+
+//=================================================================================================
+void HtmlMinifier::processComment (const char c)
+{
+    if (commentLength == 0)
+    {
+        // the conditional comments of IE are kept
+        keepComment = (c == '[');
+
+        if (keepComment)
+        {
+            writePending();
+            emit ("<!--", 4);
+        }
+    }
+
+    if (keepComment)
+        emit (c);
+
+    if (c == '>' && commentLength >= 2 && lastTwo[0] == '-' && lastTwo[1] == '-')
+    {
+        state = text;
+
+        if (keepComment)
+            afterBlock = false;
+
+        return;
+    }
+
+    lastTwo[0] = lastTwo[1];
+    lastTwo[1] = c;
+    ++commentLength;
+}
+
+//=================================================================================================
+void HtmlMinifier::processRaw (const char c)
+{
+    if (rawMatched == rawEndLength)
+    {
+        emit (rawHeld, rawMatched);
+        rawMatched = 0;
+
+        // "</pre" followed by a name-char (e.g. "</prefix") isn't the end
+        if (!isTagNameChar (c))
+        {
+            isClosingTag = true;
+            isLongName = false;
+            tagPendingSpace = false;
+            quote = 0;
+            lastTagChar = 0;
+            state = tagBody;
+            processTagBody (c);
+            return;
+        }
+    }
+
+    if (toLowerAscii (c) == rawEnd[rawMatched])
+    {
+        rawHeld[rawMatched++] = c;
+        return;
+    }
+
+    if (rawMatched > 0)
+    {
+        emit (rawHeld, rawMatched);
+        rawMatched = 0;
+
+        if (c == '<')
+        {
+            rawHeld[rawMatched++] = c;
+            return;
+        }
+    }
+
+    emit (c);
+}
+
+//=================================================================================================
+void HtmlMinifier::writePending()
+{
+    if (pendingSpace && !afterBlock)
+        emit (' ');
+
+    pendingSpace = false;
+}
+
+//=================================================================================================
+void HtmlMinifier::emit (const char c)
+{
+    if (bufferUsed == minifierBufferSize)
+    {
+        destStream->write (buffer, (size_t) bufferUsed);
+        bufferUsed = 0;
+    }
+
+    buffer[bufferUsed++] = c;
+}
+
+void HtmlMinifier::emit (const char* data, const int size)
+{
+    for (int i = 0; i < size; ++i)
+        emit (data[i]);
+}
+
+//=================================================================================================
+const bool HtmlMinifier::isBlockTag (const char* tagName) noexcept
+{
+    static const char* const names[] =
+    {
+        "!doctype", "html", "head", "body", "title", "meta", "link", "base", "style", "script",
+        "noscript", "div", "p", "ul", "ol", "li", "dl", "dt", "dd", "table", "thead", "tbody",
+        "tfoot", "tr", "td", "th", "caption", "colgroup", "col", "h1", "h2", "h3", "h4", "h5",
+        "h6", "hr", "br", "blockquote", "pre", "section", "article", "header", "footer", "nav",
+        "aside", "main", "figure", "figcaption", "form", "fieldset", "legend", "address", "center"
+    };
+
+    return isOneOf (tagName, names, numElementsInArray (names));
+}
+
+const bool HtmlMinifier::isRawTag (const char* tagName) noexcept
+{
+    static const char* const names[] = { "pre", "code", "textarea", "script", "style" };
+
+    return isOneOf (tagName, names, numElementsInArray (names));
+}
+
+//=================================================================================================
+const String HtmlMinifier::minifyCss (const String& css)
+{
+    const char* const s = css.toRawUTF8();
+    const int length = (int) css.getNumBytesAsUTF8();
+
+    HeapBlock<char> out ((size_t) length + 1);
+    int n = 0;
+    bool pending = false;
+
+    // no space is needed after or before these
+    static const char* const afterChars = "{};,>:(";
+    static const char* const beforeChars = "{};,>)";
+
+    for (int i = 0; i < length; ++i)
+    {
+        const char c = s[i];
+
+        if (c == '/' && i + 1 < length && s[i + 1] == '*')
+        {
+            const bool keep = (i + 2 < length && s[i + 2] == '!');
+            int end = i + 2;
+
+            while (end < length && !(s[end] == '*' && end + 1 < length && s[end + 1] == '/'))
+                ++end;
+
+            end = jmin (end + 2, length);
+
+            if (keep)
+            {
+                if (pending && n > 0)
+                    out[n++] = ' ';
+
+                while (i < end)
+                    out[n++] = s[i++];
+
+                pending = false;
+            }
+            else
+            {
+                pending = true;
+            }
+
+            i = end - 1;
+            continue;
+        }
+
+        if (isSpaceChar (c))
+        {
+            pending = true;
+            continue;
+        }
+
+        if (pending && n > 0 && strchr (afterChars, out[n - 1]) == nullptr
+            && strchr (beforeChars, c) == nullptr)
+            out[n++] = ' ';
+
+        pending = false;
+
+        if (c == '"' || c == '\'')
+        {
+            out[n++] = s[i++];
+
+            while (i < length && s[i] != c)
+            {
+                if (s[i] == '\\' && i + 1 < length)
+                    out[n++] = s[i++];
+
+                out[n++] = s[i++];
+            }
+
+            if (i < length)
+                out[n++] = s[i];
+
+            continue;
+        }
+
+        if (c == '}' && n > 0 && out[n - 1] == ';')
+            --n;
+
+        out[n++] = c;
+    }
+
+    return String::fromUTF8 (out, n);
+}
+
+//=================================================================================================
+const String HtmlMinifier::minifyJs (const String& js)
+{
+    const char* const s = js.toRawUTF8();
+    const int length = (int) js.getNumBytesAsUTF8();
+
+    HeapBlock<char> out ((size_t) length + 1);
+    int n = 0;
+    bool pendingSpace = false;
+    bool pendingNewLine = false;
+
+    // the space between them and anything else is never needed ('+', '-', '/' and '.' aren't
+    // here: "a + +b", "a - -b", "1 .toFixed()")
+    static const char* const operatorChars = "{}()[];,=:<>?&|*%^~";
+
+    // a newline after them could be dropped since a statement won't end there
+    static const char* const continueChars = "{;,";
+
+    static const char* const regexKeywords[] =
+    {
+        "return", "typeof", "case", "do", "else", "in", "of", "new", "delete", "void", "throw",
+        "instanceof", "yield"
+    };
+
+    for (int i = 0; i < length; ++i)
+    {
+        const char c = s[i];
+
+        if (c == '\n')
+        {
+            pendingNewLine = true;
+            continue;
+        }
+
+        if (isSpaceChar (c) || c == '\v')
+        {
+            pendingSpace = true;
+            continue;
+        }
+
+        if (c == '/' && i + 1 < length && s[i + 1] == '/')
+        {
+            while (i + 1 < length && s[i + 1] != '\n')
+                ++i;
+
+            continue;
+        }
+
+        const bool keepComment = (c == '/' && i + 2 < length && s[i + 1] == '*' && s[i + 2] == '!');
+
+        if (c == '/' && i + 1 < length && s[i + 1] == '*' && !keepComment)
+        {
+            int end = i + 2;
+
+            while (end < length && !(s[end] == '*' && end + 1 < length && s[end + 1] == '/'))
+            {
+                if (s[end] == '\n')
+                    pendingNewLine = true;
+
+                ++end;
+            }
+
+            pendingSpace = true;
+            i = jmin (end + 1, length - 1);
+            continue;
+        }
+
+        const char prev = (n > 0) ? out[n - 1] : 0;
+
+        // a '/' after a value (a name, a number, ')' or ']') is a division, else it begins a regex
+        bool isRegex = false;
+
+        if (c == '/' && !keepComment)
+        {
+            isRegex = !(isIdentifierChar (prev) || prev == ')' || prev == ']');
+
+            if (prev >= 'a' && prev <= 'z')
+            {
+                int wordStart = n - 1;
+
+                while (wordStart > 0 && out[wordStart - 1] >= 'a' && out[wordStart - 1] <= 'z')
+                    --wordStart;
+
+                const String word (out + wordStart, (size_t) (n - wordStart));
+                const bool isIdentifierPart = wordStart > 0
+                    && (isIdentifierChar (out[wordStart - 1]) || out[wordStart - 1] == '.');
+
+                for (int k = 0; k < numElementsInArray (regexKeywords) && !isIdentifierPart; ++k)
+                    if (word == regexKeywords[k])
+                        isRegex = true;
+            }
+        }
+
+        if (n > 0)
+        {
+            if (pendingNewLine && strchr (continueChars, prev) == nullptr)
+                out[n++] = '\n';
+            else if ((pendingSpace || pendingNewLine)
+                     && strchr (operatorChars, prev) == nullptr && strchr (operatorChars, c) == nullptr)
+                out[n++] = ' ';
+        }
+
+        pendingSpace = false;
+        pendingNewLine = false;
+
+        if (keepComment)
+        {
+            int end = i + 3;
+
+            while (end < length && !(s[end] == '*' && end + 1 < length && s[end + 1] == '/'))
+                ++end;
+
+            end = jmin (end + 2, length);
+
+            while (i < end)
+                out[n++] = s[i++];
+
+            --i;
+            continue;
+        }
+
+        if (c == '"' || c == '\'' || c == '`' || isRegex)
+        {
+            // copied as it is, a string (or a regex) never goes across the lines except `...`
+            bool inClass = false;
+            out[n++] = s[i++];
+
+            while (i < length)
+            {
+                const char d = s[i];
+
+                if (d == '\n' && c != '`')
+                {
+                    --i;
+                    break;
+                }
+
+                out[n++] = d;
+
+                if (d == '\\' && i + 1 < length)
+                {
+                    out[n++] = s[++i];
+                }
+                else if (isRegex && d == '[')
+                {
+                    inClass = true;
+                }
+                else if (isRegex && d == ']')
+                {
+                    inClass = false;
+                }
+                else if (d == c && !inClass)
+                {
+                    break;
+                }
+
+                ++i;
+            }
+
+            continue;
+        }
+
+        out[n++] = c;
+    }
+
+    return String::fromUTF8 (out, n);
+}
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    HtmlMinifier.h
+    Created: 16 Oct 2026 6:05:51pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#ifndef HTMLMINIFIER_H_INCLUDED
+#define HTMLMINIFIER_H_INCLUDED
+
+/** An OutputStream which minifies the html written to it on the fly and passes the result to
+    another stream, so a page could be minified while it's being written piece by piece.
+
+    - a run of white-spaces becomes one space, and it's dropped when it's next to a block-level
+      tag (<div>, <p>, <li>, <br>, <td>...), at the beginning or the end of the page
+    - the white-spaces inside a tag are collapsed (but never inside a quoted value)
+    - the comments are removed, except the conditional ones (<!--[if IE]>...)
+    - the content of <pre>, <code>, <textarea>, <script> and <style> is kept as it is
+
+    The same html always gives the same bytes, no matter how it's split into the writes.
+    Everything is passed on when the stream is deleted.
+*/
+class HtmlMinifier  : public OutputStream
+{
+public:
+    HtmlMinifier (OutputStream* destStream, const bool deleteDestStreamWhenDestroyed);
+    ~HtmlMinifier();
+
+    /** It only flushes the dest stream, a few bytes (e.g. a tag which hasn't been ended)
+        could be held until more is written or the stream is deleted. */
+    void flush() override;
+    bool write (const void* data, size_t numBytes) override;
+
+    /** the number of the bytes which have been written (before minified) */
+    int64 getPosition() override                { return numBytesIn; }
+    bool setPosition (int64) override           { return false; }
+
+    //=================================================================================================
+    /** Remove the comments (except the license ones, which begin with a '!') and the white-spaces
+        which don't matter. */
+    static const String minifyCss (const String& css);
+
+    /** Remove the comments (except the license ones, which begin with a '!'), the indent and the
+        empty lines, and collapse the white-spaces. The line breaks are kept, so the statements which
+        end without a ';' are still right. */
+    static const String minifyJs (const String& js);
+
+private:
+    //=================================================================================================
+    enum State { text, tagName, tagBody, comment, raw };
+
+    void process (const char c);
+    void processTagName (const char c);
+    void processTagBody (const char c);
+    void processComment (const char c);
+    void processRaw (const char c);
+
+    /** the name of the tag is complete, decide the white-spaces before it */
+    void beginTag();
+    void endTag();
+
+    void emit (const char c);
+    void emit (const char* data, const int size);
+    void writePending();
+
+    static const bool isBlockTag (const char* name) noexcept;
+    static const bool isRawTag (const char* name) noexcept;
+
+    OptionalScopedPointer<OutputStream> destStream;
+    HeapBlock<char> buffer;
+    int bufferUsed;
+    int64 numBytesIn;
+
+    State state;
+    bool pendingSpace, afterBlock;
+
+    // the tag which is being written
+    char name[16];
+    int nameLength;
+    bool isClosingTag, isLongName, tagPendingSpace;
+    char quote, lastTagChar;
+
+    // "<!--", the first char decides whether it's kept
+    int commentLength;
+    bool keepComment;
+    char lastTwo[2];
+
+    // "</pre" which ends the raw content, and the bytes which have matched it and been held
+    char rawEnd[16], rawHeld[16];
+    int rawEndLength, rawMatched;
+
+    JUCE_DECLARE_NON_COPYABLE (HtmlMinifier)
+};
+
+
+#endif  // HTMLMINIFIER_H_INCLUDED
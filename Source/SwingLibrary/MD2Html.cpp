@@ -9,746 +9,2752 @@
 */
 
 #include "JuceHeader.h"
-#include "../HtmlProcessor.h"
 #include "MD2Html.h"
+#include "CodeHighlighter.h"
+
+//=================================================================================================
+/** A read-only view of UTF-8 text. All the positions are byte offsets, so looking at a char
+    or searching a mark from a position costs nothing but the bytes it passes.
+
+    All the Markdown marks are ASCII (except the Chinese brackets, which are searched as their
+    whole UTF-8 sequence), and an ASCII byte never appears inside a multi-byte UTF-8 char,
+    that's why the text could be scanned byte by byte.
+*/
+struct Md2Html::TextView
+{
+    TextView (const String& text)
+        : data (text.toRawUTF8()), size ((int) text.getNumBytesAsUTF8())
+    {
+    }
+
+    TextView (const void* data_, const int size_)
+        : data (static_cast<const char*> (data_)), size (size_)
+    {
+    }
+
+    /** return 0 if the index is out of the text */
+    const char operator[] (const int index) const noexcept
+    {
+        return isPositiveAndBelow (index, size) ? data[index] : 0;
+    }
+
+    const bool startsWith (const int index, const int end, const char* target) const noexcept
+    {
+        for (int i = index; *target != 0; ++i, ++target)
+        {
+            if (i >= end || data[i] != *target)
+                return false;
+        }
+
+        return true;
+    }
+
+    /** return -1 if the target isn't in [start, end) */
+    const int indexOf (int start, const int end, const char* target) const noexcept
+    {
+        for (; start < end; ++start)
+        {
+            start = indexOfChar (start, end, *target);
+
+            if (start == -1)
+                return -1;
+
+            if (startsWith (start, end, target))
+                return start;
+        }
+
+        return -1;
+    }
+
+    static const char toLowerAscii (const char c) noexcept
+    {
+        return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c;
+    }
+
+    /** only for the ASCII target */
+    const int indexOfIgnoreCase (int start, const int end, const char* target) const noexcept
+    {
+        const int targetLength = (int) strlen (target);
+
+        for (; start + targetLength <= end; ++start)
+        {
+            int i = 0;
+
+            while (i < targetLength && toLowerAscii (data[start + i]) == toLowerAscii (target[i]))
+                ++i;
+
+            if (i == targetLength)
+                return start;
+        }
+
+        return -1;
+    }
+
+    const int indexOfChar (const int start, const int end, const char c) const noexcept
+    {
+        if (start >= end)
+            return -1;
+
+        const void* const found = memchr (data + start, c, (size_t) (end - start));
+        return (found != nullptr) ? (int) (static_cast<const char*> (found) - data) : -1;
+    }
+
+    /** the end of the run of the same char, e.g. "***" */
+    const int getRunEnd (int start, const int end) const noexcept
+    {
+        const char c = data[start];
+
+        while (start < end && data[start] == c)
+            ++start;
+
+        return start;
+    }
+
+    /** skip ' ', '\t', the line breaks and the Chinese full-width space */
+    const int skipWhitespace (int start, const int end) const noexcept
+    {
+        while (start < end)
+        {
+            if (startsWith (start, end, "\xe3\x80\x80"))
+                start += 3;
+            else if (data[start] == ' ' || data[start] == '\t' || data[start] == '\r' || data[start] == '\n')
+                ++start;
+            else
+                break;
+        }
+
+        return start;
+    }
+
+    /** the reverse of skipWhitespace() */
+    const int skipWhitespaceBackwards (const int start, int end) const noexcept
+    {
+        while (end > start)
+        {
+            if (end - 3 >= start && startsWith (end - 3, end, "\xe3\x80\x80"))
+                end -= 3;
+            else if (data[end - 1] == ' ' || data[end - 1] == '\t' || data[end - 1] == '\r' || data[end - 1] == '\n')
+                --end;
+            else
+                break;
+        }
+
+        return end;
+    }
+
+    /** move forward the number of chars (not bytes) */
+    const int skipChars (int start, int numChars, const int end) const noexcept
+    {
+        while (numChars-- > 0 && start < end)
+        {
+            ++start;
+
+            while (start < end && (data[start] & 0xc0) == 0x80)
+                ++start;
+        }
+
+        return start;
+    }
+
+    const String substring (const int start, const int end) const
+    {
+        if (end <= start)
+            return String();
+
+        return String (CharPointer_UTF8 (data + start), CharPointer_UTF8 (data + end));
+    }
+
+    void writeTo (OutputStream& out, const int start, const int end) const
+    {
+        if (end > start)
+            out.write (data + start, (size_t) (end - start));
+    }
+
+    const char* const data;
+    const int size;
+};
+
+//=================================================================================================
+/** Walks the Markdown document once, from the first line to the last one.
+
+    Every line is classified as a part of a block (code, table, heading, list-item, paragraph...)
+    and the text of the block is handed to renderInline(), which scans it byte by byte and
+    writes the html of all the inline marks in the same walk. The lines and the blocks are
+    only byte ranges of the source, nothing is copied out of it until it's written, and all
+    the html goes to one growing buffer.
+
+    Bold, italic, highlight and inline-code are switches of the whole document (an unmatched
+    mark keeps its switch on until the next one), endnotes are numbered in the order they
+    appear and the [TOC] is filled in after the walk, when all the headings are known.
+
+    The result is the html lines (joined by newLine) which the Rewriter (cleanUp()) expects.
+    writeHtml() gives them to the Rewriter piece by piece, only the buffer of the walk is kept.
+
+    With a BlockCache, the walk goes block by block, a block which is in the cache is copied
+    from it and its changes of the state are applied without parsing it again.
+
+    A large document is parsed block by block on a ThreadPool. Every block is parsed as if
+    nothing was left open before it, which is almost always true after an empty line; the
+    blocks whose guess was wrong (an unclosed emphasis before them, or the endnote numbers
+    have to begin after the ones before them) are parsed again. Then the blocks are applied
+    in order, the same as the cached ones.
+*/
+class Md2Html::Parser
+{
+public:
+    Parser (const String& mdString, const Options& options, BlockCache* blockCache = nullptr);
+
+    /** the body (with the [TOC] inserted) and the endnotes, one after another */
+    void writeHtml (OutputStream& dest);
+    const String toHtml();
+    const Array<Heading> getHeadings();
+
+private:
+    /** a parser of some blocks of the document, it shares the text and the lines */
+    Parser (const Parser* const documentParser);
+
+    class BlockJob;
+
+    /** walk the whole document, the html and the headings are ready after it */
+    void parse();
+
+    /** the document which is at least this size (bytes) will be parsed on the threads */
+    enum { minParallelSize = 512 * 1024 };
+
+    enum ListType { notList = 0, orderedList, orderedNested, unorderedList, unorderedNested };
+
+    //=============================================================================================
+    // blocks
+    const bool isCodeBlockStart (const int lineIndex) const;
+    const bool isTableStart (const int lineIndex) const;
+    const bool isBlockLine (const int lineIndex) const;
+    const bool isRuleLine (const int lineIndex) const;
+    const ListType getListType (const int lineIndex) const;
+    const bool isParagraphLine (const int lineIndex) const;
+    const bool lineContains (const int lineIndex, const char* target) const;
+
+    /** where parseStep() will stop, without parsing anything */
+    const int getStepEnd (const int lineIndex) const;
+
+    /** a block is the steps up to and including an empty line */
+    const int getBlockEnd (int lineIndex) const;
+
+    /** the text of the block and everything of the state which could change its html */
+    void getBlockKey (const int lineIndex, const int blockEnd, MemoryBlock& key) const;
+
+    /** these return the index of the next unparsed line */
+    const int parseStep (const int lineIndex);
+    const int parseCachedBlock (const int lineIndex);
+    const int parseCodeBlock (const int lineIndex);
+    const int parseTable (const int lineIndex);
+    const int parseParagraph (const int lineIndex);
+
+    void parseBlockLine (const int lineIndex);
+    void parseListItem (const int lineIndex, const ListType listType);
+
+    /** parse the lines of the block and record its html and how it changed the state */
+    void parseBlock (const int lineIndex, const int blockEnd, BlockCache::Block& block);
+
+    /** write the html of the block and change the state the same as parsing it.
+        sourceStart: where the first line of the block is in the text */
+    void applyBlock (const BlockCache::Block& block, const int sourceStart);
+
+    /** for the parser of blocks. the state after the previous block, nullptr for nothing open */
+    void beginBlock (const bool isFirstBlock, const int firstNoteNumber, const BlockCache::Block* previous);
+
+    void parseInParallel (const int numThreads);
+    void parseBlocksInParallel (ThreadPool& pool, const Array<int>& blockIndexes,
+                                const Array<int>& blockStarts, OwnedArray<BlockCache::Block>& blocks) const;
+
+    void writeTableRow (const int lineIndex, const char* cellSeparator);
+    const String getTocContent() const;
+    void writeEndnotes (OutputStream& dest);
+
+    /** begin a new line of the html */
+    void startLine (const ListType listType = notList, const bool hasPrefix = false);
+    void writeNewLine (OutputStream& dest);
+    const bool lastLineStartsWith (const char* target, const bool ignoreIndent) const;
+
+    //=============================================================================================
+    // inline
+    /** afterSpace: the text follows a ' ' which isn't a part of it (e.g. "+ http://xxx.com ") */
+    void renderInline (const TextView& text, const int start, const int end,
+                       OutputStream& dest, const bool afterSpace = false);
+    void renderRange (const TextView& text, const int start, const int end, OutputStream& dest);
+
+    const int getLinkTextEnd (const TextView& text, const int start, const int end);
+    const int getEndnoteEnd (const TextView& text, const int start, const int end);
+    const bool renderEndnote (const TextView& text, int& index, const int end, OutputStream& dest);
+    const bool renderImage (const TextView& text, int& index, const int end, OutputStream& dest);
+    const bool renderLink (const TextView& text, int& index, const int end, OutputStream& dest);
+    const bool renderSpaceLink (const TextView& text, int& index, const int end, OutputStream& dest);
+
+    static const bool hasCodeEnd (const TextView& text, int start, const int end);
+
+    /** The last search of a closing mark (']', "](", ')'...) in the text of renderInline().
+        The marks are searched from the positions which mostly go forward, so the result
+        could be used again until the position passes it. Without this, every unmatched
+        opening mark (e.g. 10000 "[^" without any ']') would scan the rest of the text. */
+    struct MarkSearch
+    {
+        MarkSearch (const char* target_) : target (target_), from (0x7fffffff), found (-1) {}
+
+        const char* const target;
+        int from, found;
+    };
+
+    /** the first target in [start, end), -1 if not found */
+    const int find (const TextView& text, MarkSearch& search, const int start, const int end);
+
+    /** <pre><code>...</code></pre>, and the spans of CodeHighlighter if it knows the language */
+    void writeCode (const TextView& text, const int start, const int end, OutputStream& dest);
+
+    /** write the text as it is, but its line breaks will be newLine and escapeCode for '<' and '>' */
+    void writeText (const TextView& text, const int start, const int end,
+                    OutputStream& dest, const bool escapeCode);
+
+    //=============================================================================================
+    const String source;
+    const TextView text;
+    Array<Range<int> > documentLines;
+    const Array<Range<int> >& lines;
+    const Options options;
+    const bool tocEnabled;
+    BlockCache* const blockCache;
+
+    // the last line which contains "```", a code-block without it after couldn't be closed
+    int lastFenceLine;
+
+    MemoryOutputStream html;
+    MemoryOutputStream scratch;
+    int lineNumbers;
+
+    // the last line of the html (its offset), the list-items need it to decide their <ol>/<ul>
+    int lastLineStart;
+    ListType lastListType;
+    bool lastHasPrefix;
+
+    // the switches of the whole document
+    bool boldItalic, bold, italic, highlight, inlineCode;
+
+    // the '*' and '<' inside `code` are not parsed, but only when the code has its closing '`'
+    bool codeProtected;
+
+    // endnotes
+    int noteNumber;
+    Array<int> noteNumbers;
+    StringArray notes;
+
+    // the text which is being rendered by renderInline()
+    int unitStart, unitEnd;
+    bool unitAfterSpace;
+    MarkSearch noteEndSearch, pathStartSearch, pathEndSearch, fenceSearch, bracketSearch;
+
+    // Chinese brackets, only one pair could be opened
+    int bracketEnd;
+
+    // [TOC]. where it should be inserted into the html (only the first [TOC] has the content).
+    // the headings (their positions are byte offsets here) and the '#' lines of the paragraphs
+    // (level 0, they aren't headings but one of them may be the title which the [TOC] skips)
+    int tocPosition;
+    Array<Heading> headings;
+
+    JUCE_DECLARE_NON_COPYABLE (Parser)
+};
+
+//=================================================================================================
+Md2Html::Options::Options()
+    : endnotesTitle ("Endnote(s): "),
+      highlightColour ("#bbdddd"),
+      tableOfContents (true),
+      endnotes (true),
+      autoLinks (true),
+      chineseBrackets (true),
+      highlightCode (true)
+{
+}
+
+//=================================================================================================
+const Md2Html::Options Md2Html::Options::getLocalised()
+{
+    Options options;
+    options.endnotesTitle = TRANS ("Endnote(s): ");
+
+    return options;
+}
+
+//=================================================================================================
+const bool Md2Html::Options::operator== (const Options& other) const noexcept
+{
+    return endnotesTitle == other.endnotesTitle
+        && highlightColour == other.highlightColour
+        && tableOfContents == other.tableOfContents
+        && endnotes == other.endnotes
+        && autoLinks == other.autoLinks
+        && chineseBrackets == other.chineseBrackets
+        && highlightCode == other.highlightCode;
+}
+
+const bool Md2Html::Options::operator!= (const Options& other) const noexcept
+{
+    return !operator== (other);
+}
 
 //=================================================================================================
 const String Md2Html::mdStringToHtml (const String& mdString)
 {
-    if (mdString.isEmpty())
-        return String();
+    return mdStringToHtml (mdString, Options::getLocalised());
+}
+
+//=================================================================================================
+void Md2Html::mdStringToHtml (const String& mdString, OutputStream& outputStream)
+{
+    mdStringToHtml (mdString, outputStream, Options::getLocalised());
+}
+
+//=================================================================================================
+const String Md2Html::mdStringToHtml (const String& mdString, const Options& options, BlockCache* blockCache)
+{
+    if (mdString.isEmpty())
+        return String();
+
+    MemoryOutputStream html ((size_t) mdString.getNumBytesAsUTF8() * 2 + 256);
+    mdStringToHtml (mdString, html, options, blockCache);
+
+    return html.toUTF8();
+}
+
+
+//=================================================================================================
+const Array<Md2Html::Heading> Md2Html::getHeadings (const String& mdString, const Options& options,
+                                                    BlockCache* blockCache)
+{
+    if (mdString.isEmpty())
+        return Array<Heading>();
+
+    Parser parser (mdString, options, blockCache);
+    return parser.getHeadings();
+}
+
+//=================================================================================================
+/** the html of a block and how the block changed the state of the Parser */
+struct Md2Html::BlockCache::Block
+{
+    MemoryBlock key, html;
+    int lastConversion;
+
+    // the endnote number before the block (its html has the numbers after it).
+    // the numbers of the notes and the positions are relative to the beginning of the block
+    int firstNoteNumber;
+    StringArray notes;
+    Array<int> noteNumbers;
+    int numNoteNumbers;
+
+    // the positions of the headings are relative to the first line of the block
+    Array<Heading> headings;
+    int tocPosition;
+
+    int numLines, lastLineStart, lastListType;
+    bool lastHasPrefix;
+
+    bool boldItalic, bold, italic, highlight, inlineCode, codeProtected;
+
+    const bool hasOpenSwitch() const noexcept
+    {
+        return boldItalic || bold || italic || highlight || inlineCode || codeProtected;
+    }
+};
+
+//=================================================================================================
+Md2Html::BlockCache::BlockCache()
+    : conversion (0)
+{
+}
+
+Md2Html::BlockCache::~BlockCache()
+{
+}
+
+//=================================================================================================
+void Md2Html::BlockCache::clear()
+{
+    blocksByHash.clear();
+    blocks.clear();
+}
+
+//=================================================================================================
+Md2Html::BlockCache::Block* const Md2Html::BlockCache::find (const MemoryBlock& key) const
+{
+    Block* const block = blocksByHash[getHash (key)];
+
+    if (block == nullptr || block->key != key)
+        return nullptr;
+
+    block->lastConversion = conversion;
+    return block;
+}
+
+//=================================================================================================
+void Md2Html::BlockCache::add (Block* newBlock)
+{
+    newBlock->lastConversion = conversion;
+    blocks.add (newBlock);
+    blocksByHash.set (getHash (newBlock->key), newBlock);
+
+    if (blocksByHash.size() > blocksByHash.getNumSlots())
+        blocksByHash.remapTable (blocksByHash.size() * 2);
+}
+
+//=================================================================================================
+const int Md2Html::BlockCache::getHash (const MemoryBlock& key) noexcept
+{
+    // FNV-1a
+    const uint8* const data = static_cast<const uint8*> (key.getData());
+    uint32 hash = 2166136261u;
+
+    for (size_t i = 0; i < key.getSize(); ++i)
+        hash = (hash ^ data[i]) * 16777619u;
+
+    return (int) (hash & 0x7fffffff);
+}
+
+//=================================================================================================
+void Md2Html::BlockCache::removeUnused()
+{
+    for (int i = blocks.size(); --i >= 0; )
+    {
+        if (blocks.getUnchecked (i)->lastConversion != conversion)
+        {
+            // another block with the same hash may have replaced it
+            const int hash = getHash (blocks.getUnchecked (i)->key);
+
+            if (blocksByHash[hash] == blocks.getUnchecked (i))
+                blocksByHash.remove (hash);
+
+            // the order doesn't matter, and the blocks after i have been checked
+            blocks.swap (i, blocks.size() - 1);
+            blocks.removeLast();
+        }
+    }
+}
+
+//=================================================================================================
+Md2Html::Parser::Parser (const String& mdString, const Options& options_, BlockCache* blockCache_)
+    : source (mdString),
+      text (source),
+      lines (documentLines),
+      options (options_),
+      tocEnabled (options.tableOfContents && mdString.contains ("[TOC]") && mdString.contains ("# ")),
+      blockCache (blockCache_),
+      lastFenceLine (-1),
+      html ((size_t) text.size * 2 + 256),
+      lineNumbers (0),
+      lastLineStart (0),
+      lastListType (notList),
+      lastHasPrefix (false),
+      boldItalic (false),
+      bold (false),
+      italic (false),
+      highlight (false),
+      inlineCode (false),
+      codeProtected (false),
+      noteNumber (0),
+      unitStart (0),
+      unitEnd (0),
+      unitAfterSpace (false),
+      noteEndSearch ("]"),
+      pathStartSearch ("]("),
+      pathEndSearch (")"),
+      fenceSearch ("```"),
+      bracketSearch ("\xef\xbc\x89"),
+      bracketEnd (-1),
+      tocPosition (-1)
+{
+    // the same as StringArray::addLines(): "\n", "\r\n" and "\r" are all line breaks
+    int lineStart = 0;
+
+    for (int i = 0; i < text.size; ++i)
+    {
+        if (text.data[i] == '\n' || text.data[i] == '\r')
+        {
+            documentLines.add (Range<int> (lineStart, i));
+
+            if (text.data[i] == '\r' && text[i + 1] == '\n')
+                ++i;
+
+            lineStart = i + 1;
+        }
+    }
+
+    documentLines.add (Range<int> (lineStart, text.size));
+
+    for (int i = lines.size(); --i >= 0; )
+    {
+        if (lineContains (i, "```"))
+        {
+            lastFenceLine = i;
+            break;
+        }
+    }
+}
+
+//=================================================================================================
+Md2Html::Parser::Parser (const Parser* const documentParser)
+    : source (documentParser->source),
+      text (source),
+      lines (documentParser->lines),
+      options (documentParser->options),
+      tocEnabled (documentParser->tocEnabled),
+      blockCache (nullptr),
+      lastFenceLine (documentParser->lastFenceLine),
+      lineNumbers (0),
+      lastLineStart (0),
+      lastListType (notList),
+      lastHasPrefix (false),
+      boldItalic (false),
+      bold (false),
+      italic (false),
+      highlight (false),
+      inlineCode (false),
+      codeProtected (false),
+      noteNumber (0),
+      unitStart (0),
+      unitEnd (0),
+      unitAfterSpace (false),
+      noteEndSearch ("]"),
+      pathStartSearch ("]("),
+      pathEndSearch (")"),
+      fenceSearch ("```"),
+      bracketSearch ("\xef\xbc\x89"),
+      bracketEnd (-1),
+      tocPosition (-1)
+{
+}
+
+//=================================================================================================
+void Md2Html::Parser::parse()
+{
+    if (blockCache != nullptr)
+    {
+        // the html of the blocks depends on the options
+        if (blockCache->options != options)
+        {
+            blockCache->clear();
+            blockCache->options = options;
+        }
+
+        ++blockCache->conversion;
+
+        for (int i = 0; i < lines.size(); )
+            i = parseCachedBlock (i);
+
+        blockCache->removeUnused();
+    }
+    else if (text.size >= minParallelSize && SystemStats::getNumCpus() > 1)
+    {
+        parseInParallel (SystemStats::getNumCpus());
+    }
+    else
+    {
+        for (int i = 0; i < lines.size(); )
+            i = parseStep (i);
+    }
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeHtml (OutputStream& dest)
+{
+    parse();
+
+    // the trailing whitespace of the body is dropped before the endnotes, but never the [TOC]
+    const TextView body (html.getData(), (int) html.getDataSize());
+    const int bodyEnd = (notes.size() > 0) ? jmax (body.skipWhitespaceBackwards (0, body.size), tocPosition)
+                                           : body.size;
+
+    if (tocPosition != -1)
+    {
+        body.writeTo (dest, 0, tocPosition);
+        dest << getTocContent();
+        body.writeTo (dest, tocPosition, bodyEnd);
+    }
+    else
+    {
+        body.writeTo (dest, 0, bodyEnd);
+    }
+
+    if (notes.size() > 0)
+        writeEndnotes (dest);
+}
+
+const String Md2Html::Parser::toHtml()
+{
+    MemoryOutputStream result ((size_t) text.size * 2 + 256);
+    writeHtml (result);
+
+    return result.toUTF8();
+}
+
+//=================================================================================================
+const Array<Md2Html::Heading> Md2Html::Parser::getHeadings()
+{
+    parse();
+
+    Array<Heading> result;
+    result.ensureStorageAllocated (headings.size());
+
+    // count the chars up to the positions, they only go forward
+    int byteIndex = 0, charIndex = 0;
+
+    for (int i = 0; i < headings.size(); ++i)
+    {
+        const Heading& heading (headings.getReference (i));
+
+        if (heading.level == 0)
+            continue;
+
+        for (; byteIndex < heading.position; ++byteIndex)
+        {
+            if ((text.data[byteIndex] & 0xc0) != 0x80)
+                ++charIndex;
+        }
+
+        result.add (heading);
+        result.getReference (result.size() - 1).position = charIndex;
+    }
+
+    return result;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::parseStep (const int lineIndex)
+{
+    if (isCodeBlockStart (lineIndex))
+        return parseCodeBlock (lineIndex);
+
+    if (isTableStart (lineIndex))
+        return parseTable (lineIndex);
+
+    if (isRuleLine (lineIndex))
+    {
+        startLine();
+        html << "<p>";
+    }
+    else if (isBlockLine (lineIndex))
+    {
+        parseBlockLine (lineIndex);
+    }
+    else if (getListType (lineIndex) != notList)
+    {
+        parseListItem (lineIndex, getListType (lineIndex));
+    }
+    else if (lines.getReference (lineIndex).isEmpty())
+    {
+        startLine();
+    }
+    else
+    {
+        return parseParagraph (lineIndex);
+    }
+
+    return lineIndex + 1;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::getStepEnd (const int lineIndex) const
+{
+    if (isCodeBlockStart (lineIndex))
+    {
+        const Range<int>& line (lines.getReference (lineIndex));
+        const int fenceStart = text.indexOf (line.getStart(), line.getEnd(), "```");
+
+        if (text.indexOf (fenceStart + 4, line.getEnd(), "```") != -1)
+            return lineIndex + 1;
+
+        int endLine = lineIndex + 1;
+
+        while (endLine < lines.size() && !lineContains (endLine, "```"))
+            ++endLine;
+
+        return jmin (endLine + 1, lines.size());
+    }
+
+    if (isTableStart (lineIndex))
+    {
+        int endLine = lineIndex + 2;
+
+        while (endLine < lines.size() && lineContains (endLine, " | "))
+            ++endLine;
+
+        return endLine;
+    }
+
+    if (isRuleLine (lineIndex) || isBlockLine (lineIndex) || getListType (lineIndex) != notList
+         || lines.getReference (lineIndex).isEmpty())
+        return lineIndex + 1;
+
+    int endLine = lineIndex + 1;
+
+    while (endLine < lines.size() && isParagraphLine (endLine))
+        ++endLine;
+
+    return endLine;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::getBlockEnd (int lineIndex) const
+{
+    while (lineIndex < lines.size())
+    {
+        const bool isEmptyLine = lines.getReference (lineIndex).isEmpty();
+        lineIndex = getStepEnd (lineIndex);
+
+        if (isEmptyLine)
+            break;
+    }
+
+    return lineIndex;
+}
+
+//=================================================================================================
+void Md2Html::Parser::getBlockKey (const int lineIndex, const int blockEnd, MemoryBlock& key) const
+{
+    const int start = lines.getReference (lineIndex).getStart();
+    const int end = (blockEnd < lines.size()) ? lines.getReference (blockEnd).getStart() : text.size;
+
+    // a block begins after an empty line (its html is an empty line too) or at the beginning
+    // of the document, so the list-items and their <ol>/<ul> don't need to be in the key
+    const int flags = (lineNumbers == 0 ? 1 : 0)
+                    | (boldItalic ? 2 : 0) | (bold ? 4 : 0) | (italic ? 8 : 0)
+                    | (highlight ? 16 : 0) | (inlineCode ? 32 : 0) | (codeProtected ? 64 : 0)
+                    | (tocEnabled ? 128 : 0) | (tocPosition == -1 ? 256 : 0)
+                    | (lastFenceLine >= blockEnd ? 512 : 0);
+
+    // the number of the endnotes only matters to the block which has any endnote
+    const int firstNoteNumber = (text.indexOf (start, end, "[^") != -1) ? noteNumber : 0;
+
+    key.setSize ((size_t) (end - start) + sizeof (flags) + sizeof (firstNoteNumber));
+    key.copyFrom (&flags, 0, sizeof (flags));
+    key.copyFrom (&firstNoteNumber, (int) sizeof (flags), sizeof (firstNoteNumber));
+    key.copyFrom (text.data + start, (int) (sizeof (flags) + sizeof (firstNoteNumber)), (size_t) (end - start));
+}
+
+//=================================================================================================
+const int Md2Html::Parser::parseCachedBlock (const int lineIndex)
+{
+    const int blockEnd = getBlockEnd (lineIndex);
+    MemoryBlock key;
+    getBlockKey (lineIndex, blockEnd, key);
+
+    if (const BlockCache::Block* const block = blockCache->find (key))
+    {
+        applyBlock (*block, lines.getReference (lineIndex).getStart());
+    }
+    else
+    {
+        ScopedPointer<BlockCache::Block> newBlock (new BlockCache::Block());
+        parseBlock (lineIndex, blockEnd, *newBlock);
+
+        newBlock->key.swapWith (key);
+        blockCache->add (newBlock.release());
+    }
+
+    return blockEnd;
+}
+
+//=================================================================================================
+void Md2Html::Parser::parseBlock (const int lineIndex, const int blockEnd, BlockCache::Block& block)
+{
+    const int htmlStart = (int) html.getPosition();
+    const int firstNote = notes.size();
+    const int firstHeading = headings.size();
+    const int sourceStart = lines.getReference (lineIndex).getStart();
+    const int firstLineNumber = lineNumbers;
+    const int lastTocPosition = tocPosition;
+
+    block.firstNoteNumber = noteNumber;
+
+    for (int i = lineIndex; i < blockEnd; )
+        i = parseStep (i);
+
+    block.html.replaceWith (static_cast<const char*> (html.getData()) + htmlStart,
+                            html.getPosition() - (size_t) htmlStart);
+
+    block.notes.clear();
+    block.noteNumbers.clear();
+    block.headings.clearQuick();
+
+    for (int i = firstNote; i < notes.size(); ++i)
+    {
+        block.notes.add (notes[i]);
+        block.noteNumbers.add (noteNumbers[i] - block.firstNoteNumber);
+    }
+
+    for (int i = firstHeading; i < headings.size(); ++i)
+    {
+        block.headings.add (headings.getReference (i));
+        block.headings.getReference (block.headings.size() - 1).position -= sourceStart;
+    }
+
+    block.tocPosition = (tocPosition != lastTocPosition) ? tocPosition - htmlStart : -1;
+    block.numNoteNumbers = noteNumber - block.firstNoteNumber;
+    block.numLines = lineNumbers - firstLineNumber;
+    block.lastLineStart = lastLineStart - htmlStart;
+    block.lastListType = lastListType;
+    block.lastHasPrefix = lastHasPrefix;
+
+    block.boldItalic = boldItalic;
+    block.bold = bold;
+    block.italic = italic;
+    block.highlight = highlight;
+    block.inlineCode = inlineCode;
+    block.codeProtected = codeProtected;
+}
+
+//=================================================================================================
+void Md2Html::Parser::applyBlock (const BlockCache::Block& block, const int sourceStart)
+{
+    const int htmlStart = (int) html.getPosition();
+    html.write (block.html.getData(), block.html.getSize());
+
+    for (int i = 0; i < block.notes.size(); ++i)
+    {
+        notes.add (block.notes[i]);
+        noteNumbers.add (noteNumber + block.noteNumbers[i]);
+    }
+
+    for (int i = 0; i < block.headings.size(); ++i)
+    {
+        headings.add (block.headings.getReference (i));
+        headings.getReference (headings.size() - 1).position += sourceStart;
+    }
+
+    // only the first [TOC] has the content
+    if (block.tocPosition != -1 && tocPosition == -1)
+        tocPosition = htmlStart + block.tocPosition;
+
+    noteNumber += block.numNoteNumbers;
+    lineNumbers += block.numLines;
+    lastLineStart = htmlStart + block.lastLineStart;
+    lastListType = (ListType) block.lastListType;
+    lastHasPrefix = block.lastHasPrefix;
+
+    boldItalic = block.boldItalic;
+    bold = block.bold;
+    italic = block.italic;
+    highlight = block.highlight;
+    inlineCode = block.inlineCode;
+    codeProtected = block.codeProtected;
+}
+
+//=================================================================================================
+void Md2Html::Parser::beginBlock (const bool isFirstBlock, const int firstNoteNumber,
+                                  const BlockCache::Block* previous)
+{
+    html.reset();
+
+    // the blocks after the first one begin after an empty line
+    lineNumbers = isFirstBlock ? 0 : 1;
+    lastLineStart = 0;
+    lastListType = notList;
+    lastHasPrefix = false;
+
+    boldItalic = (previous != nullptr && previous->boldItalic);
+    bold = (previous != nullptr && previous->bold);
+    italic = (previous != nullptr && previous->italic);
+    highlight = (previous != nullptr && previous->highlight);
+    inlineCode = (previous != nullptr && previous->inlineCode);
+    codeProtected = (previous != nullptr && previous->codeProtected);
+
+    noteNumber = firstNoteNumber;
+    notes.clear();
+    noteNumbers.clear();
+    headings.clearQuick();
+
+    // the html of [TOC] is the same whether it's the first one or not
+    tocPosition = -1;
+}
+
+//=================================================================================================
+/** Parses some blocks of the document with its own Parser. Each block begins with nothing
+    open and its Block::firstNoteNumber. */
+class Md2Html::Parser::BlockJob : public ThreadPoolJob
+{
+public:
+    BlockJob (const Parser& documentParser_, const Array<int>& blockIndexes_,
+              const Array<int>& blockStarts_, OwnedArray<BlockCache::Block>& blocks_)
+        : ThreadPoolJob ("Md2Html blocks"),
+          documentParser (documentParser_),
+          blockIndexes (blockIndexes_),
+          blockStarts (blockStarts_),
+          blocks (blocks_)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        Parser parser (&documentParser);
+
+        for (int i = 0; i < blockIndexes.size(); ++i)
+        {
+            const int blockIndex = blockIndexes.getUnchecked (i);
+            BlockCache::Block& block (*blocks.getUnchecked (blockIndex));
+
+            parser.beginBlock (blockIndex == 0, block.firstNoteNumber, nullptr);
+            parser.parseBlock (blockStarts.getUnchecked (blockIndex), blockStarts.getUnchecked (blockIndex + 1), block);
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    const Parser& documentParser;
+    const Array<int> blockIndexes;
+    const Array<int>& blockStarts;
+    OwnedArray<BlockCache::Block>& blocks;
+
+    JUCE_DECLARE_NON_COPYABLE (BlockJob)
+};
+
+//=================================================================================================
+void Md2Html::Parser::parseInParallel (const int numThreads)
+{
+    Array<int> blockStarts, allBlocks;
+
+    for (int i = 0; i < lines.size(); i = getBlockEnd (i))
+    {
+        allBlocks.add (blockStarts.size());
+        blockStarts.add (i);
+    }
+
+    blockStarts.add (lines.size());
+
+    OwnedArray<BlockCache::Block> blocks;
+
+    for (int i = 0; i < allBlocks.size(); ++i)
+        blocks.add (new BlockCache::Block())->firstNoteNumber = 0;
+
+    ThreadPool pool (numThreads);
+    parseBlocksInParallel (pool, allBlocks, blockStarts, blocks);
+
+    // find out the blocks which were parsed with the wrong guess
+    Parser blockParser (this);
+    Array<int> renumberedBlocks;
+    int nextNoteNumber = 0;
+
+    for (int i = 0; i < blocks.size(); ++i)
+    {
+        BlockCache::Block& block (*blocks.getUnchecked (i));
+        const BlockCache::Block* const previous = blocks[i - 1];
+
+        // its state depends on the previous one, so it must be parsed again right now
+        if (previous != nullptr && previous->hasOpenSwitch())
+        {
+            blockParser.beginBlock (false, nextNoteNumber, previous);
+            blockParser.parseBlock (blockStarts.getUnchecked (i), blockStarts.getUnchecked (i + 1), block);
+        }
+
+        // only the numbers of its endnotes are wrong
+        else if (block.numNoteNumbers > 0 && block.firstNoteNumber != nextNoteNumber)
+        {
+            block.firstNoteNumber = nextNoteNumber;
+            renumberedBlocks.add (i);
+        }
+
+        nextNoteNumber += block.numNoteNumbers;
+    }
+
+    if (renumberedBlocks.size() > 0)
+        parseBlocksInParallel (pool, renumberedBlocks, blockStarts, blocks);
+
+    for (int i = 0; i < blocks.size(); ++i)
+        applyBlock (*blocks.getUnchecked (i), lines.getReference (blockStarts.getUnchecked (i)).getStart());
+}
+
+//=================================================================================================
+void Md2Html::Parser::parseBlocksInParallel (ThreadPool& pool, const Array<int>& blockIndexes,
+                                             const Array<int>& blockStarts,
+                                             OwnedArray<BlockCache::Block>& blocks) const
+{
+    // about the same number of bytes for each job, a few more jobs than the threads
+    // to balance the slower ones
+    const int numJobs = pool.getNumThreads() * 4;
+    int64 totalBytes = 0;
+
+    for (int i = 0; i < blockIndexes.size(); ++i)
+        totalBytes += lines.getReference (blockStarts[blockIndexes[i] + 1] - 1).getEnd()
+                      - lines.getReference (blockStarts[blockIndexes[i]]).getStart();
+
+    OwnedArray<BlockJob> jobs;
+    Array<int> jobBlocks;
+    int64 jobBytes = 0;
+
+    for (int i = 0; i < blockIndexes.size(); ++i)
+    {
+        const int blockIndex = blockIndexes.getUnchecked (i);
+
+        jobBlocks.add (blockIndex);
+        jobBytes += lines.getReference (blockStarts[blockIndex + 1] - 1).getEnd()
+                    - lines.getReference (blockStarts[blockIndex]).getStart();
+
+        if (jobBytes * numJobs >= totalBytes || i == blockIndexes.size() - 1)
+        {
+            pool.addJob (jobs.add (new BlockJob (*this, jobBlocks, blockStarts, blocks)), false);
+            jobBlocks.clearQuick();
+            jobBytes = 0;
+        }
+    }
+
+    for (int i = 0; i < jobs.size(); ++i)
+        pool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+}
+
+//=================================================================================================
+void Md2Html::Parser::startLine (const ListType listType, const bool hasPrefix)
+{
+    if (lineNumbers++ > 0)
+        html << newLine;
+
+    lastLineStart = (int) html.getPosition();
+    lastListType = listType;
+    lastHasPrefix = hasPrefix;
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeNewLine (OutputStream& dest)
+{
+    dest << newLine;
+
+    if (&dest == &html)
+        lastLineStart = (int) html.getPosition();
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::lastLineStartsWith (const char* target, const bool ignoreIndent) const
+{
+    const TextView lastLine (html.getData(), (int) html.getDataSize());
+    const int start = ignoreIndent ? lastLine.skipWhitespace (lastLineStart, lastLine.size) : lastLineStart;
+
+    return lastLine.startsWith (start, lastLine.size, target);
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::lineContains (const int lineIndex, const char* target) const
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    return text.indexOf (line.getStart(), line.getEnd(), target) != -1;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::isCodeBlockStart (const int lineIndex) const
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    const int fenceStart = text.indexOf (line.getStart(), line.getEnd(), "```");
+
+    if (fenceStart == -1 || text.skipWhitespace (line.getStart(), fenceStart) != fenceStart)
+        return false;
+
+    return text.indexOf (fenceStart + 4, line.getEnd(), "```") != -1 || lastFenceLine > lineIndex;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::isTableStart (const int lineIndex) const
+{
+    return lineIndex + 2 < lines.size()
+        && text.startsWith (lines.getReference (lineIndex + 1).getStart(),
+                            lines.getReference (lineIndex + 1).getEnd(), "------")
+        && lineContains (lineIndex, " | ")
+        && lineContains (lineIndex + 2, " | ");
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::isRuleLine (const int lineIndex) const
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    return text.startsWith (line.getStart(), line.getEnd(), "******");
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::isBlockLine (const int lineIndex) const
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    const int s = text.skipWhitespace (line.getStart(), line.getEnd());
+    const int end = line.getEnd();
+
+    return text.startsWith (s, end, "---")
+        || text.startsWith (s, end, "> ")
+        || text.startsWith (s, end, "# ")
+        || text.startsWith (s, end, "## ")
+        || text.startsWith (s, end, "### ")
+        || text.startsWith (s, end, "#### ")
+        || text.startsWith (s, end, "##### ")
+        || text.startsWith (s, end, "###### ")
+        || text.startsWith (s, end, ">|< ")
+        || text.startsWith (s, end, ">>> ")
+        || text.startsWith (s, end, "^^ ");
+}
+
+//=================================================================================================
+const Md2Html::Parser::ListType Md2Html::Parser::getListType (const int lineIndex) const
+{
+    if (lineIndex >= lines.size() || isTableStart (lineIndex))
+        return notList;
+
+    const int start = lines.getReference (lineIndex).getStart();
+    const int end = lines.getReference (lineIndex).getEnd();
+
+    if (text.startsWith (start, end, "+ "))           return orderedList;
+    if (text.startsWith (start, end, "    + "))       return orderedNested;
+    if (text.startsWith (start, end, "- "))           return unorderedList;
+    if (text.startsWith (start, end, "    - "))       return unorderedNested;
+
+    return notList;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::isParagraphLine (const int lineIndex) const
+{
+    return !lines.getReference (lineIndex).isEmpty()
+        && !isRuleLine (lineIndex)
+        && !isBlockLine (lineIndex)
+        && getListType (lineIndex) == notList
+        && !isTableStart (lineIndex)
+        && !isCodeBlockStart (lineIndex);
+}
+
+//=================================================================================================
+const int Md2Html::Parser::parseCodeBlock (const int lineIndex)
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    const int fenceStart = text.indexOf (line.getStart(), line.getEnd(), "```");
+
+    // ```code``` in one line, or the first line which has the closing "```"
+    int fenceEnd = text.indexOf (fenceStart + 4, line.getEnd(), "```");
+    int endLine = lineIndex;
+
+    while (fenceEnd == -1 && ++endLine < lines.size())
+        fenceEnd = text.indexOf (lines.getReference (endLine).getStart(), lines.getReference (endLine).getEnd(), "```");
+
+    startLine();
+    text.writeTo (html, line.getStart(), fenceStart);
+
+    // its line breaks are written as newLine by writeText()
+    writeCode (text, fenceStart + 3, fenceEnd, html);
+    renderInline (text, fenceEnd + 3, lines.getReference (endLine).getEnd(), html);
+
+    return endLine + 1;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::parseTable (const int lineIndex)
+{
+    startLine();
+    html << "<table>";
+
+    startLine();
+    html << "<tr><th>";
+    writeTableRow (lineIndex, "</th><th>");
+    html << "</th></tr>";
+
+    int i = lineIndex + 2;
+
+    for (; i < lines.size() && lineContains (i, " | "); ++i)
+    {
+        startLine();
+        html << "<tr><td align=\"right\">";
+        writeTableRow (i, "</td><td>");
+        html << "</td></tr>";
+    }
+
+    startLine();
+    html << "</table>";
+
+    return i;
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeTableRow (const int lineIndex, const char* cellSeparator)
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    int cellStart = line.getStart();
+
+    for (int separator = text.indexOf (cellStart, line.getEnd(), " | "); separator != -1;
+         separator = text.indexOf (cellStart, line.getEnd(), " | "))
+    {
+        renderInline (text, cellStart, separator, html);
+        html << cellSeparator;
+        cellStart = separator + 3;
+    }
+
+    renderInline (text, cellStart, line.getEnd(), html);
+}
+
+//=================================================================================================
+const int Md2Html::Parser::parseParagraph (const int lineIndex)
+{
+    int endLine = lineIndex;
+
+    do
+    {
+        const Range<int>& line (lines.getReference (endLine));
+
+        if (text[text.skipWhitespace (line.getStart(), line.getEnd())] == '#')
+        {
+            Heading notHeading;
+            notHeading.level = 0;
+            notHeading.position = line.getStart();
+
+            headings.add (notHeading);
+        }
+
+    } while (++endLine < lines.size() && isParagraphLine (endLine));
+
+    // the line breaks inside it are written as newLine by renderRange()
+    startLine();
+    renderInline (text, lines.getReference (lineIndex).getStart(), lines.getReference (endLine - 1).getEnd(), html);
+
+    return endLine;
+}
+
+//=================================================================================================
+void Md2Html::Parser::parseBlockLine (const int lineIndex)
+{
+    const Range<int>& line (lines.getReference (lineIndex));
+    const int s = text.skipWhitespace (line.getStart(), line.getEnd());
+    const int end = line.getEnd();
+
+    // <hr>. the rest of the line will be dropped (after its marks have been counted)
+    if (text.startsWith (s, end, "---"))
+    {
+        scratch.reset();
+        renderInline (text, s, end, scratch);
+
+        startLine();
+        html << "<hr>";
+    }
+
+    // <blockquote>
+    else if (text.startsWith (s, end, "> "))
+    {
+        startLine();
+        html << "<blockquote>";
+        renderInline (text, s + 2, end, html);
+        html << "</blockquote>";
+    }
+
+    // <h1> ~ <h6>, h1 ~ h3 have the anchor
+    else if (text[s] == '#')
+    {
+        const int level = text.getRunEnd (s, end) - s;
+
+        scratch.reset();
+        renderInline (text, s + level + 1, end, scratch);
+        const String content (scratch.toUTF8());
+
+        Heading heading;
+        heading.level = level;
+        heading.text = text.substring (s + level + 1, end).trim();
+        heading.anchor = (level <= 3) ? content : String();
+        heading.position = line.getStart();
+
+        headings.add (heading);
+        startLine();
+
+        if (level <= 3)
+            html << "<h" << level << " id=\"" << content << "\">" << content << "</h" << level << ">";
+        else
+            html << "<h" << level << ">" << content << "</h" << level << ">";
+    }
+
+    // align
+    else if (text.startsWith (s, end, ">|< "))
+    {
+        startLine();
+        html << "<div align=center>";
+        renderInline (text, text.skipChars (line.getStart(), 4, end), end, html);
+        html << "</div>";
+    }
+
+    else if (text.startsWith (s, end, ">>> "))
+    {
+        startLine();
+        html << "<div align=right>";
+        renderInline (text, text.skipChars (line.getStart(), 4, end), end, html);
+        html << "</div>";
+    }
+
+    // diagram description
+    else if (text.startsWith (s, end, "^^ "))
+    {
+        startLine();
+        html << "<h5 align=center>";
+        renderInline (text, text.skipChars (line.getStart(), 3, end), end, html);
+        html << "</h5></div>";
+    }
+}
+
+//=================================================================================================
+void Md2Html::Parser::parseListItem (const int lineIndex, const ListType listType)
+{
+    const bool isOrdered = (listType == orderedList || listType == orderedNested);
+    const bool isNested = (listType == orderedNested || listType == unorderedNested);
+    const ListType nextType = getListType (lineIndex + 1);
+    bool hasPrefix = false;
+
+    // whether this item begins a new list (or a new nested list)
+    if (listType == orderedNested)
+        hasPrefix = (lastListType == notList) ? !(lastLineStartsWith ("    <ol>", false) || lastLineStartsWith ("    <li>", false))
+                                              : lastListType != orderedNested;
+
+    else if (listType == orderedList)
+        hasPrefix = (lastListType == notList) ? !(lastLineStartsWith ("<li>", true) || lastLineStartsWith ("<ol>", true))
+                                              : (lastListType == unorderedList || lastListType == unorderedNested);
+
+    else if (listType == unorderedNested)
+        hasPrefix = (lastListType == notList) ? !(lastLineStartsWith ("    <ul>", false) || lastLineStartsWith ("    <li>", false))
+                                              : (lastListType == orderedNested ? lastHasPrefix
+                                                                               : lastListType != unorderedNested);
+
+    else
+        hasPrefix = (lastListType == notList) ? !(lastLineStartsWith ("<li>", true) || lastLineStartsWith ("<ul>", true))
+                                              : ((lastListType == orderedList || lastListType == orderedNested) && lastHasPrefix);
+
+    // whether this item ends the list (or the nested list)
+    const ListType sameNested (isOrdered ? orderedNested : unorderedNested);
+    const ListType sameTop (isOrdered ? orderedList : unorderedList);
+    const bool hasPostfix = isNested ? (nextType != sameNested)
+                                     : (nextType != sameNested && nextType != sameTop);
+
+    const char* const listStart = isOrdered ? "<ol>" : "<ul>";
+    const char* const listEnd = isOrdered ? "</ol>" : "</ul>";
+    const char* const indent = isNested ? "    " : "";
+
+    startLine (listType, hasPrefix);
+
+    if (hasPrefix)
+        html << indent << listStart;
+
+    html << indent << "<li>";
+    renderInline (text, lines.getReference (lineIndex).getStart() + (isNested ? 6 : 2),
+                  lines.getReference (lineIndex).getEnd(), html, true);
+    html << "</li>";
+
+    if (hasPostfix)
+        html << indent << listEnd;
+
+    // the last nested item which isn't followed by an item of its parent list closes them both
+    if (isNested && hasPostfix && nextType != sameTop)
+        html << listEnd;
+}
+
+//=================================================================================================
+const String Md2Html::Parser::getTocContent() const
+{
+    StringArray tocLines;
+
+    // doesn't extract the title (the first line which starts with '#'),
+    // nor the indented headings (their line doesn't start with '#')
+    for (int i = 1; i < headings.size(); ++i)
+    {
+        const Heading& heading (headings.getReference (i));
+
+        if (text[heading.position] != '#')
+            continue;
+
+        const String link ("<a href=\"#" + heading.anchor + "\">" + heading.anchor + "</a><br>");
+
+        if (heading.level == 1)
+            tocLines.add (link);
+
+        else if (heading.level == 2)
+            tocLines.add (" &emsp;&emsp;" + String (CharPointer_UTF8 ("\xc2\xb7")) + " " + link);
+
+        else if (heading.level == 3)
+            tocLines.add (" &emsp;&emsp;&emsp;&emsp;" + String (CharPointer_UTF8 ("\xc2\xb7")) + " " + link);
+    }
+
+    return "<div class=toc>" + tocLines.joinIntoString (newLine) + "</div>";
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeEndnotes (OutputStream& dest)
+{
+    dest << newLine << "<hr>" << newLine;
 
-    // parse markdown, must followed by these order
-    String htmlContent (mdString);
+    const String title ("**" + options.endnotesTitle + "**");
+    const TextView titleView (title);
+    renderInline (titleView, 0, titleView.size, dest);
 
-    htmlContent = tableParse (htmlContent);
-    htmlContent = identifierParse (htmlContent);
-    htmlContent = codeBlockParse (htmlContent);
-    htmlContent = endnoteParse (htmlContent);
-    htmlContent = inlineCodeParse (htmlContent);
-    htmlContent = boldAndItalicParse (htmlContent);
-    htmlContent = boldParse (htmlContent);
-    htmlContent = italicParse (htmlContent);
-    htmlContent = highlightParse (htmlContent);
-    htmlContent = tocParse (htmlContent);
-    htmlContent = processByLine (htmlContent);
-    htmlContent = spaceLinkParse (htmlContent);
-    htmlContent = imageParse (htmlContent);
-    htmlContent = mdLinkParse (htmlContent);
-    htmlContent = orderedListParse (htmlContent, true);
-    htmlContent = orderedListParse (htmlContent, false);
-    htmlContent = cnBracketParse (htmlContent);
-    htmlContent = cleanUp (htmlContent);
+    dest << newLine << "<ol><div class=endnote>";
+
+    for (int i = 0; i < notes.size(); ++i)
+    {
+        const String note (notes[i]);
+        const TextView noteView (note);
+
+        dest << newLine << "<li><span id=\"endnote-" << noteNumbers[i] << "\">";
+        renderInline (noteView, 0, noteView.size, dest);
+        dest << "</span></li>" << newLine;
+    }
 
-    //DBG (htmlContent);
-    return htmlContent;
+    dest << newLine << "</ol></div>";
 }
 
 //=================================================================================================
-const String Md2Html::tableParse (const String& mdString)
+void Md2Html::Parser::renderInline (const TextView& text, const int start, const int end,
+                                    OutputStream& dest, const bool afterSpace)
 {
-    StringArray contentByLine;
-    contentByLine.addLines (mdString);
+    unitStart = start;
+    unitEnd = end;
+    unitAfterSpace = afterSpace;
+    bracketEnd = -1;
 
-    contentByLine.insert (0, "%%__table@MDtag@Parse__%%");
-    contentByLine.add ("%%__table@MDtag@Parse__%%");
+    noteEndSearch.from = pathStartSearch.from = pathEndSearch.from = fenceSearch.from
+        = bracketSearch.from = 0x7fffffff;
 
-    for (int i = 1; i < contentByLine.size() - 1; ++i)
+    renderRange (text, start, end, dest);
+
+    if (bracketEnd != -1)
+        dest << "</span>";
+
+    bracketEnd = -1;
+}
+
+//=================================================================================================
+void Md2Html::Parser::renderRange (const TextView& text, const int start, const int end, OutputStream& dest)
+{
+    // the plain text between the marks is written in one go
+    int plainStart = start;
+
+    for (int i = start; i < end; )
     {
-        String& prevLine = contentByLine.getReference (i - 1);
-        String& currentLine (contentByLine.getReference (i));
-        String& nextLine = contentByLine.getReference (i + 1);
+        const char c = text.data[i];
 
-        if (currentLine.substring (0, 6) == "------"
-            && prevLine.contains (" | ")
-            && nextLine.contains (" | "))
+        if (c != '\\' && c != '*' && c != '~' && c != '`' && c != '[' && c != '!' && c != 'h' && c != 'H'
+            && c != '\r' && c != '\n' && c != '<' && c != '\xef')
         {
-            currentLine = prevLine;
-            prevLine = "<table>";
+            ++i;
+            continue;
+        }
 
-            currentLine = "<tr><th>" + currentLine.replace (" | ", "</th><th>") + "</th></tr>";
-            nextLine = "<tr><td align=\"right\">" + nextLine.replace (" | ", "</td><td>") + "</td></tr>";
+        text.writeTo (dest, plainStart, i);
+        const char next = (i + 1 < end) ? text.data[i + 1] : 0;
 
-            int rowNums = i + 1;
+        // escape. the '\' is kept here and will be removed by cleanUp()
+        if (c == '\\' && (next == '*' || next == '~' || next == '`'))
+        {
+            const int runEnd = text.getRunEnd (i + 1, end);
+            text.writeTo (dest, i, runEnd);
+            i = runEnd;
+        }
+        else if (c == '\\' && (next == '[' || (next == '!' && i + 2 < end && text.data[i + 2] == '[')))
+        {
+            const int markEnd = (next == '[') ? i + 2 : i + 3;
+            text.writeTo (dest, i, markEnd);
+            i = markEnd;
+        }
 
-            while (++rowNums < contentByLine.size())
+        // ***, **, *
+        else if (c == '*')
+        {
+            const int runEnd = text.getRunEnd (i, end);
+            const int runLength = runEnd - i;
+
+            if (codeProtected || runLength > 3)
+            {
+                text.writeTo (dest, i, runEnd);
+            }
+            else
             {
-                String& thisLine = contentByLine.getReference (rowNums);
+                if (runLength == 3)
+                {
+                    dest << (boldItalic ? "</strong></em>" : "<em><strong>");
+                    boldItalic = !boldItalic;
+                }
 
-                if (thisLine.contains (" | "))
+                if (runLength == 2)
                 {
-                    thisLine = "<tr><td align=\"right\">" + thisLine.replace (" | ", "</td><td>") + "</td></tr>";
+                    dest << (bold ? "</strong>" : "<strong>");
+                    bold = !bold;
                 }
                 else
                 {
-                    contentByLine.insert (rowNums, "</table>");
-                    break;
+                    dest << (italic ? "</em>" : "<em>");
+                    italic = !italic;
                 }
             }
 
-            i = rowNums;
+            i = runEnd;
+        }
+
+        // ~~
+        else if (c == '~')
+        {
+            const int runEnd = text.getRunEnd (i, end);
+
+            if (runEnd - i == 2)
+            {
+                if (highlight)
+                    dest << "</span>";
+                else
+                    dest << "<span style=\"background: " << options.highlightColour << "\">";
+
+                highlight = !highlight;
+            }
+            else
+            {
+                text.writeTo (dest, i, runEnd);
+            }
+
+            i = runEnd;
+        }
+
+        // ```code``` inside a paragraph, `
+        else if (c == '`')
+        {
+            const int runEnd = text.getRunEnd (i, end);
+            const int fenceEnd = (runEnd - i >= 3) ? find (text, fenceSearch, i + 4, end) : -1;
+
+            if (fenceEnd != -1)
+            {
+                writeCode (text, i + 3, fenceEnd, dest);
+                i = fenceEnd + 3;
+            }
+            else if (runEnd - i == 1)
+            {
+                dest << (inlineCode ? "</code>" : "<code>");
+                inlineCode = !inlineCode;
+                codeProtected = inlineCode && hasCodeEnd (text, runEnd, end);
+                i = runEnd;
+            }
+            else
+            {
+                text.writeTo (dest, i, runEnd);
+                i = runEnd;
+            }
+        }
+
+        // [^endnote], [TOC], [link](path)
+        else if (c == '[')
+        {
+            if (next == '^' && options.endnotes && renderEndnote (text, i, end, dest))
+            {
+            }
+            else if (tocEnabled && text.startsWith (i, end, "[TOC]"))
+            {
+                // the rendered headings and the endnotes don't have the [TOC]
+                if (&dest != &html)
+                    dest << "[TOC]";
+                else if (tocPosition == -1)
+                    tocPosition = (int) html.getPosition();
+
+                i += 5;
+            }
+            else if (!renderLink (text, i, end, dest))
+            {
+                const int markEnd = (next == '^') ? i + 2 : i + 1;
+                text.writeTo (dest, i, markEnd);
+                i = markEnd;
+            }
+        }
+
+        // ![image](path)
+        else if (c == '!' && next == '[')
+        {
+            if (!renderImage (text, i, end, dest))
+            {
+                dest << "![";
+                i += 2;
+            }
+        }
+
+        // " http://xxx.com "
+        else if (c == 'h' || c == 'H')
+        {
+            const char before = (i == unitStart) ? (unitAfterSpace ? ' ' : 0) : text.data[i - 1];
+
+            if (before != ' ' || !options.autoLinks || !renderSpaceLink (text, i, end, dest))
+            {
+                dest << c;
+                ++i;
+            }
+        }
+
+        // Chinese brackets
+        else if (c == '\xef' && options.chineseBrackets && bracketEnd == -1
+                 && text.startsWith (i, end, "\xef\xbc\x88"))
+        {
+            const int closeIndex = find (text, bracketSearch, i + 3, end);
+
+            if (closeIndex > i + 3)
+            {
+                dest << "\xef\xbc\x88" << "<span class=cnBracket>";
+                bracketEnd = closeIndex;
+            }
+            else
+            {
+                dest << "\xef\xbc\x88";
+            }
+
+            i += 3;
+        }
+        else if (c == '\xef' && i == bracketEnd)
+        {
+            dest << "</span>" << "\xef\xbc\x89";
+            bracketEnd = -1;
+            i += 3;
+        }
+
+        // the line breaks inside a paragraph
+        else if (c == '\r' || c == '\n')
+        {
+            i += (c == '\r' && next == '\n') ? 2 : 1;
+            writeNewLine (dest);
+        }
+
+        else if (c == '<' && codeProtected)
+        {
+            dest << "&lt;";
+            ++i;
+        }
+        else
+        {
+            dest << c;
+            ++i;
+        }
+
+        plainStart = i;
+    }
+
+    text.writeTo (dest, plainStart, end);
+}
+
+//=================================================================================================
+const int Md2Html::Parser::getEndnoteEnd (const TextView& text, const int start, const int end)
+{
+    int noteEnd = find (text, noteEndSearch, start + 2, end);
+
+    // need to process the link mark which may inside endnote
+    if (noteEnd != -1 && noteEnd + 1 < end && text.data[noteEnd + 1] == '(')
+        noteEnd = find (text, noteEndSearch, noteEnd + 2, end);
+
+    return noteEnd;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::renderEndnote (const TextView& text, int& index, const int end, OutputStream& dest)
+{
+    const int noteEnd = getEndnoteEnd (text, index, end);
+
+    if (noteEnd == -1 || text.data[noteEnd - 1] == '\\')
+        return false;
+
+    ++noteNumber;
+
+    if (text.skipWhitespace (index + 2, noteEnd) == noteEnd)
+        return false;
+
+    notes.add (text.substring (index + 2, noteEnd));
+    noteNumbers.add (noteNumber);
+
+    dest << "<sup><a href=\"#endnote-" << noteNumber << "\">"
+         << "[" << noteNumber << "]</a></sup>";
+
+    index = noteEnd + 1;
+    return true;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::renderImage (const TextView& text, int& index, const int end, OutputStream& dest)
+{
+    const int altEnd = find (text, pathStartSearch, index + 2, end);
+    const int pathEnd = (altEnd == -1) ? -1 : find (text, pathEndSearch, altEnd + 2, end);
+
+    if (pathEnd == -1)
+        return false;
+
+    dest << "<div align=center><img src=\"";
+    writeText (text, altEnd + 2, pathEnd, dest, false);
+    dest << "\" alt=\"";
+    renderRange (text, index + 2, altEnd, dest);
+    dest << "\" />" << "</div>";
+
+    index = pathEnd + 1;
+    return true;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::getLinkTextEnd (const TextView& text, const int start, const int end)
+{
+    // a link begins at the last '[' before its "](", but the images and the endnotes
+    // inside the link text are not counted
+    for (int i = start; i + 1 < end; ++i)
+    {
+        const char c = text.data[i];
+
+        if (c == ']' && text.data[i + 1] == '(')
+            return i;
+
+        if (c != '[')
+            continue;
+
+        if (i > start && text.data[i - 1] == '!')
+        {
+            const int altEnd = find (text, pathStartSearch, i + 1, end);
+            const int pathEnd = (altEnd == -1) ? -1 : find (text, pathEndSearch, altEnd + 2, end);
+
+            if (pathEnd == -1)
+                return -1;
+
+            i = pathEnd;
+        }
+        else if (text.data[i + 1] == '^')
+        {
+            const int noteEnd = getEndnoteEnd (text, i, end);
+
+            if (noteEnd == -1)
+                return -1;
+
+            i = noteEnd;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::renderLink (const TextView& text, int& index, const int end, OutputStream& dest)
+{
+    const int textEnd = getLinkTextEnd (text, index + 1, end);
+    const int pathEnd = (textEnd == -1) ? -1 : find (text, pathEndSearch, textEnd + 2, end);
+
+    if (pathEnd == -1)
+        return false;
+
+    int linkEnd = text.skipWhitespaceBackwards (textEnd + 2, pathEnd);
+
+    // [](http://xxx.com/xxx.html -), the end ' -' will open the link in new window
+    const bool newWindow = (linkEnd - 2 >= textEnd + 2 && text.startsWith (linkEnd - 2, linkEnd, " -"));
+
+    if (newWindow)
+        linkEnd -= 2;
+
+    dest << "<a href=\"";
+    writeText (text, textEnd + 2, linkEnd, dest, false);
+    dest << (newWindow ? "\" target=\"_blank\">" : "\">");
+
+    renderRange (text, index + 1, textEnd, dest);
+    dest << "</a>";
+
+    index = pathEnd + 1;
+    return true;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::renderSpaceLink (const TextView& text, int& index, const int end, OutputStream& dest)
+{
+    if (index + 4 > end
+        || (text.data[index + 1] != 't' && text.data[index + 1] != 'T')
+        || (text.data[index + 2] != 't' && text.data[index + 2] != 'T')
+        || (text.data[index + 3] != 'p' && text.data[index + 3] != 'P'))
+        return false;
+
+    const int linkEnd = text.indexOfChar (text.skipChars (index, 9, end), end, ' ');
+
+    if (linkEnd == -1
+        || text.indexOfChar (index, linkEnd, '\n') != -1
+        || text.indexOfChar (index, linkEnd, '\r') != -1)
+        return false;
+
+    dest << "<a href=\"";
+    text.writeTo (dest, index, linkEnd);
+    dest << "\" target=\"_blank\">";
+    text.writeTo (dest, index, linkEnd);
+    dest << "</a>";
+
+    index = linkEnd;
+    return true;
+}
+
+//=================================================================================================
+const int Md2Html::Parser::find (const TextView& text, MarkSearch& search, const int start, const int end)
+{
+    // the last result is still the first target after the start
+    if (search.from > start || (search.found != -1 && search.found < start))
+    {
+        search.from = start;
+        search.found = text.indexOf (start, unitEnd, search.target);
+    }
+
+    if (search.found == -1 || search.found + (int) strlen (search.target) > end)
+        return -1;
+
+    return search.found;
+}
+
+//=================================================================================================
+const bool Md2Html::Parser::hasCodeEnd (const TextView& text, int start, const int end)
+{
+    for (start = text.indexOfChar (start, end, '`'); start != -1; start = text.indexOfChar (start, end, '`'))
+    {
+        const int runEnd = text.getRunEnd (start, end);
+
+        if (runEnd - start == 1 && text.data[start - 1] != '\\')
+            return true;
+
+        start = runEnd;
+    }
+
+    return false;
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeCode (const TextView& text, const int start, const int end, OutputStream& dest)
+{
+    Array<CodeHighlighter::Token> tokens;
+
+    if (!options.highlightCode
+         || CodeHighlighter::highlight (text.data + start, end - start, tokens) == CodeHighlighter::unknown)
+    {
+        dest << "<pre><code>";
+        writeText (text, start, end, dest, true);
+        dest << "</code></pre>";
+        return;
+    }
+
+    dest << "<pre><code class=hljs>";
+    int written = start;
+
+    for (int i = 0; i < tokens.size(); ++i)
+    {
+        const int tokenStart = start + tokens.getReference (i).start;
+        const int tokenEnd = start + tokens.getReference (i).end;
+
+        // a span between a '\' and the char after it would stop cleanUp() from unescaping it
+        if (tokenStart < written || text[tokenStart - 1] == '\\' || text[tokenEnd - 1] == '\\')
+            continue;
+
+        // the line breaks right after the token are inside its span, a "<br>" after a '>'
+        // would be another line break to cleanUp()
+        int spanEnd = tokenEnd;
+
+        while (spanEnd < end && (text.data[spanEnd] == '\r' || text.data[spanEnd] == '\n'))
+            ++spanEnd;
+
+        writeText (text, written, tokenStart, dest, true);
+        dest << "<span class=" << CodeHighlighter::getClassName (tokens.getReference (i).type) << ">";
+        writeText (text, tokenStart, spanEnd, dest, true);
+        dest << "</span>";
+
+        written = spanEnd;
+    }
+
+    writeText (text, written, end, dest, true);
+    dest << "</code></pre>";
+}
+
+//=================================================================================================
+void Md2Html::Parser::writeText (const TextView& text, const int start, const int end,
+                                 OutputStream& dest, const bool escapeCode)
+{
+    int plainStart = start;
+
+    for (int i = start; i < end; ++i)
+    {
+        const char c = text.data[i];
+
+        if (c == '\r' || c == '\n')
+        {
+            text.writeTo (dest, plainStart, i);
+            writeNewLine (dest);
+
+            if (c == '\r' && i + 1 < end && text.data[i + 1] == '\n')
+                ++i;
+
+            plainStart = i + 1;
+        }
+        else if (escapeCode && (c == '<' || c == '>'))
+        {
+            text.writeTo (dest, plainStart, i);
+            dest << (c == '<' ? "&lt;" : "&gt;");
+            plainStart = i + 1;
         }
     }
 
-    contentByLine.removeString ("%%__table@MDtag@Parse__%%");
-    return contentByLine.joinIntoString (newLine);
+    text.writeTo (dest, plainStart, end);
 }
 
 //=================================================================================================
-const String Md2Html::identifierParse (const String& mdString)
+const String Md2Html::imageParse (const String& mdString)
 {
-    StringArray lines;
-    lines.addLines (mdString);
-    
-    for (int i = lines.size(); --i >= 0; )
+    /**< ![](media/xxx.jpg) */
+    const TextView text (mdString);
+    MemoryOutputStream resultStr ((size_t) text.size + 256);
+    int written = 0;
+
+    for (int indexStart = text.indexOf (0, text.size, "!["); indexStart != -1;
+         indexStart = text.indexOf (written, text.size, "!["))
     {
-        if (lines[i].substring (0, 6) == "******")
-            lines.getReference (i) = "<p>";
+        // get alt content
+        const int altEnd = text.indexOf (indexStart + 2, text.size, "](");
+        if (altEnd == -1)            break;
+
+        // get img path
+        const int imgEnd = text.indexOfChar (altEnd + 2, text.size, ')');
+        if (imgEnd == -1)            break;
+
+        text.writeTo (resultStr, written, indexStart);
+        resultStr << "<div align=center><img src=\"";
+        text.writeTo (resultStr, altEnd + 2, imgEnd);
+        resultStr << "\" alt=\"";
+        text.writeTo (resultStr, indexStart + 2, altEnd);
+        resultStr << "\" />" << "</div>";
+
+        written = imgEnd + 1;
     }
 
-    return lines.joinIntoString (newLine);
+    text.writeTo (resultStr, written, text.size);
+    return resultStr.toUTF8();
 }
 
 //=================================================================================================
-const String Md2Html::codeBlockParse (const String& mdString)
+/** The passes of cleanUp() have to be done in their order: most of them work on what the ones
+    before them have written (a newLine becomes "<br>\n", a "<br>" after a tag becomes newLine
+    again, then "<pre><code>" + newLine is joined...), so they can't be matched as one flat set
+    of patterns. Instead, the passes which don't feed each other are matched together, and each
+    group is a Stage: it rewrites the text as it comes in and passes the result on to the next
+    one at once. The html goes through all of them in one walk, a few KB at a time, and is
+    written only once, to the output. A stage holds back nothing but the bytes which may be the
+    beginning of its patterns (or the code-block it's inside). */
+class Md2Html::Rewriter  : public OutputStream
 {
-    String resultStr (mdString);
-    int indexStart = resultStr.indexOfIgnoreCase (0, "```");
+public:
+    explicit Rewriter (OutputStream& output);
+    ~Rewriter();
 
-    while (indexStart != -1)
-    {
-        const int indexEnd = resultStr.indexOfIgnoreCase (indexStart + 4, "```");
+    /** the html lines, in any pieces. The bytes which may be the beginning of a pattern are
+        held back until the next piece (or finish()) tells the stage how it goes on. */
+    bool write (const void* data, size_t size) override;
 
-        if (indexEnd == -1)
-            break;
+    /** the end of the html, everything which has been held back is written to the output */
+    void finish();
 
-        const String mdCode (resultStr.substring (indexStart, indexEnd + 3));
-        const String htmlStr ("<pre><code>"
-                              + mdCode.replace ("```", String())
-                              .replace ("*", "_%5x|z%!##!_") // see cleanup(), prevent bold and italic parse it
-                              .replace ("<", "&lt;").replace (">", "&gt;")  // escape html code
-                              + "</code></pre>");
+    void flush() override                   { }
+    int64 getPosition() override            { return position; }
+    bool setPosition (int64) override       { return false; }
 
-        //DBG (htmlStr);
-        resultStr = resultStr.replaceSection (indexStart, mdCode.length(), htmlStr);
-        indexStart = resultStr.indexOfIgnoreCase (indexStart + htmlStr.length(), "```");
-    }
+private:
+    class Stage;
+    class Output;
+    class Replace;
+    class BreakAfterTag;
+    class BreaksInside;
+    class CodeBlockGaps;
+    class Unescape;
 
-    return resultStr;
-}
+    /** the first one is the Output, the text is written to the last one */
+    OwnedArray<Stage> stages;
+    int64 position;
+
+    JUCE_DECLARE_NON_COPYABLE (Rewriter)
+};
 
 //=================================================================================================
-const String Md2Html::endnoteParse (const String& mdString)
+class Md2Html::Rewriter::Stage
 {
-    String resultStr (mdString);
-    int indexStart = resultStr.indexOfIgnoreCase (0, "[^");
-    int noteNumber = 0;
-    StringArray notes;
+public:
+    explicit Stage (Stage* nextStage) : next (nextStage), numBuffered (0), numHeld (0) {}
+    virtual ~Stage() {}
 
-    while (indexStart != -1)
+    /** the text which follows what has been written before */
+    void write (const char* data, const int size)
     {
-        // get note content's end index
-        int indexEnd = resultStr.indexOfIgnoreCase (indexStart + 2, "]");
+        int done = 0;
 
-        if (indexEnd == -1)
-            break;
-
-        // need to process the link mark which may inside endnote
-        if (resultStr.substring (indexEnd + 1, indexEnd + 2) == "(")
-            indexEnd = resultStr.indexOfIgnoreCase (indexEnd + 2, "]");
-
-        if (resultStr.substring (indexStart - 1, indexStart) != "\\"
-            && resultStr.substring (indexEnd - 1, indexEnd) !="\\")
+        // the held bytes and enough of the new ones to finish (or fail) the match they begin
+        if (numHeld > 0)
         {
-            ++noteNumber;
+            const int numNew = jmin (size, (int) maxPatternLength);
+            char joined[maxPatternLength * 2];
 
-            // get note content
-            const String noteStr (resultStr.substring (indexStart + 2, indexEnd));
+            memcpy (joined, held, (size_t) numHeld);
+            memcpy (joined + numHeld, data, (size_t) numNew);
 
-            if (noteStr.trim().isNotEmpty())
-            {
-                notes.add ("<li><span id=\"endnote-" + String (noteNumber) + "\">"
-                           + noteStr + "</span></li>\n");
+            const int numJoined = numHeld + numNew;
+            const int joinedDone = rewrite (TextView (joined, numJoined), false);
 
-                resultStr = resultStr.replaceSection (indexStart + 2, noteStr.length(), String());
-                resultStr = resultStr.replaceSection (indexStart, 3, "<sup><a href=\"#endnote-"
-                                                      + String (noteNumber) + "\">"
-                                                      + "[" + String (noteNumber) + "]</a></sup>");
+            if (joinedDone < numHeld)
+            {
+                // only when all the new bytes are still too few
+                jassert (numNew == size);
+                hold (joined + joinedDone, numJoined - joinedDone);
+                return;
             }
+
+            done = joinedDone - numHeld;
+            numHeld = 0;
         }
 
-        indexStart = resultStr.indexOfIgnoreCase (indexStart + 2, "[^");
+        done += rewrite (TextView (data + done, size - done), false);
+        hold (data + done, size - done);
     }
 
-    if (notes.size() > 0)
+    /** the end of the text */
+    void finish()
     {
-        notes.insert (0, "**" + TRANS ("Endnote(s): ") + "**");
-        notes.insert (1, "<ol><div class=endnote>");
-        notes.add ("</ol></div>");
+        rewrite (TextView (held, numHeld), true);
+        numHeld = 0;
+
+        if (next != nullptr)
+        {
+            if (numBuffered > 0)
+                next->write (buffer, numBuffered);
 
-        resultStr = resultStr.trimEnd() + newLine + "----" + newLine;
-        resultStr = resultStr + notes.joinIntoString (newLine);
+            numBuffered = 0;
+            next->finish();
+        }
     }
 
-    return resultStr;
-}
+protected:
+    /** the longest text a stage needs to see at once */
+    enum { maxPatternLength = 48, bufferSize = 4096 };
 
-//=================================================================================================
-const String Md2Html::inlineCodeParse (const String& mdString)
-{
-    String resultStr (mdString);
-    int index = resultStr.indexOfIgnoreCase (0, "`");
+    /** Rewrite the beginning of the text and return how many bytes have been done. The rest
+        (a match which isn't complete yet) will be given again, followed by the new bytes.
+        When it's the last text, all of it must be done. */
+    virtual const int rewrite (const TextView& text, const bool isLast) = 0;
 
-    for (int i = 1; index != -1; ++i)
+    /** to the next stage, joined into larger pieces */
+    void emit (const char* data, const int size)
     {
-        if (resultStr.substring (index - 1, index) != "\\"
-            && resultStr.substring (index - 1, index) != "`"
-            && resultStr.substring (index + 1, index + 2) != "`")
+        if (numBuffered + size > bufferSize)
         {
-            if (i % 2 == 1)
-                resultStr = resultStr.replaceSection (index, 1, "<code>");
-            else
-                resultStr = resultStr.replaceSection (index, 1, "</code>");
+            next->write (buffer, numBuffered);
+            numBuffered = 0;
+        }
+
+        if (size >= bufferSize)
+        {
+            next->write (data, size);
         }
         else
         {
-            --i;
+            memcpy (buffer + numBuffered, data, (size_t) size);
+            numBuffered += size;
         }
-
-        index = resultStr.indexOfIgnoreCase (index + 1, "`");
     }
 
-    // for bold, italic and html code parse
-    int indexStart = resultStr.indexOfIgnoreCase (0, "<code>");
-
-    while (indexStart != -1)
+    void emit (const TextView& text, const int start, const int end)
     {
-        const int indexEnd = resultStr.indexOfIgnoreCase (indexStart + 6, "</code>");
-
-        if (indexEnd == -1)
-            break;
-
-        const String mdCode (resultStr.substring (indexStart + 1, indexEnd)
-                             .replace ("*", "_%5x|z%!##!_")
-                             .replace ("<", "&lt;"));
-
-        resultStr = resultStr.replaceSection (indexStart, indexEnd - indexStart, "<" + mdCode);
-        indexStart = resultStr.indexOfIgnoreCase (indexStart + mdCode.length(), "<code>");
+        emit (text.data + start, end - start);
     }
 
-    //DBG (resultStr);
-    return resultStr;    
-}
+    void emit (const String& text)
+    {
+        emit (text.toRawUTF8(), (int) text.getNumBytesAsUTF8());
+    }
 
-//=================================================================================================
-const String Md2Html::boldAndItalicParse (const String& mdString)
-{
-    String resultStr (mdString);
-    int index = resultStr.indexOfIgnoreCase (0, "***");
+    void emitNewLine()
+    {
+        emit (NewLine::getDefault(), (int) strlen (NewLine::getDefault()));
+    }
 
-    for (int i = 1; index != -1; ++i)
+    /** the available bytes from the index are the beginning of the ASCII target */
+    static const bool beginsLike (const TextView& text, const int index, const char* target,
+                                  const bool ignoreCase) noexcept
     {
-        if (resultStr.substring (index - 1, index) != "\\"
-            && resultStr.substring (index - 1, index) != "*"
-            && resultStr.substring (index + 3, index + 4) != "*")
-        {
-            if (i % 2 == 1)
-                resultStr = resultStr.replaceSection (index, 2, "<em><strong>");
-            else
-                resultStr = resultStr.replaceSection (index, 2, "</strong></em>");
-        }
-        else
+        for (int i = index; i < text.size && *target != 0; ++i, ++target)
         {
-            --i;
+            if ((ignoreCase ? TextView::toLowerAscii (text.data[i]) : text.data[i]) != *target)
+                return false;
         }
 
-        index = resultStr.indexOfIgnoreCase (index + 3, "***");
+        return true;
     }
 
-    //DBG (resultStr);
-    return resultStr;
-}
-
-//=================================================================================================
-const String Md2Html::boldParse (const String& mdString)
-{
-    String resultStr (mdString);
-    int index = resultStr.indexOfIgnoreCase (0, "**");
+    Stage* const next;
 
-    for (int i = 1; index != -1; ++i)
+private:
+    void hold (const char* data, const int size)
     {
-        if (resultStr.substring (index - 1, index) != "\\"
-            && resultStr.substring (index - 1, index) != "*"
-            && resultStr.substring (index + 2, index + 3) != "*")
-        {
-            if (i % 2 == 1)
-                resultStr = resultStr.replaceSection (index, 2, "<strong>");
-            else
-                resultStr = resultStr.replaceSection (index, 2, "</strong>");
-        }
-        else
-        {
-            --i;
-        }
-
-        index = resultStr.indexOfIgnoreCase (index + 2, "**");
+        jassert (size <= maxPatternLength);
+        memcpy (held, data, (size_t) size);
+        numHeld = size;
     }
 
-    //DBG (resultStr);
-    return resultStr;
-}
+    char buffer[bufferSize];
+    int numBuffered;
+
+    char held[maxPatternLength];
+    int numHeld;
+
+    JUCE_DECLARE_NON_COPYABLE (Stage)
+};
 
 //=================================================================================================
-const String Md2Html::italicParse (const String& mdString)
+class Md2Html::Rewriter::Output : public Md2Html::Rewriter::Stage
 {
-    String resultStr (mdString);
-    int index = resultStr.indexOfIgnoreCase (0, "*");
+public:
+    explicit Output (OutputStream& outputStream) : Stage (nullptr), output (outputStream) {}
 
-    for (int i = 1; index != -1; ++i)
+private:
+    const int rewrite (const TextView& text, const bool /*isLast*/) override
     {
-        if (resultStr.substring (index - 1, index) != "\\"
-            && resultStr.substring (index - 1, index) != "*"
-            && resultStr.substring (index + 1, index + 2) != "*")
-        {
-            if (i % 2 == 1)
-                resultStr = resultStr.replaceSection (index, 1, "<em>");
-            else
-                resultStr = resultStr.replaceSection (index, 1, "</em>");
-        }
-        else
-        {
-            --i;
-        }
-
-        index = resultStr.indexOfIgnoreCase (index + 1, "*");
+        output.write (text.data, (size_t) text.size);
+        return text.size;
     }
 
-    //DBG (resultStr);
-    return resultStr;
-}
+    OutputStream& output;
+};
 
 //=================================================================================================
-const String Md2Html::highlightParse (const String& mdString)
+/** The same as String::replace(). When there's the second target, it's tried after the first
+    one at the same index, so both of them must begin with the same char. */
+class Md2Html::Rewriter::Replace : public Md2Html::Rewriter::Stage
 {
-    String resultStr (mdString);
-    int index = resultStr.indexOfIgnoreCase (0, "~~");
+public:
+    Replace (Stage* nextStage, const String& target, const String& replacement,
+             const String& secondTarget = String(), const String& secondReplacement = String())
+        : Stage (nextStage)
+    {
+        targets[0] = target;
+        targets[1] = secondTarget;
+        replacements[0] = replacement;
+        replacements[1] = secondReplacement;
+        numTargets = secondTarget.isEmpty() ? 1 : 2;
+
+        jassert ((int) target.getNumBytesAsUTF8() <= maxPatternLength);
+        jassert (numTargets == 1 || secondTarget[0] == target[0]);
+    }
 
-    for (int i = 1; index != -1; ++i)
+private:
+    const int rewrite (const TextView& text, const bool isLast) override
     {
-        if (resultStr.substring (index - 1, index) != "\\"
-            && resultStr.substring (index - 1, index) != "~"
-            && resultStr.substring (index + 2, index + 3) != "~")
-        {
-            if (i % 2 == 1)
-                resultStr = resultStr.replaceSection (index, 2, "<span style=\"background: #bbdddd\">");
-            else
-                resultStr = resultStr.replaceSection (index, 2, "</span>");
-        }
-        else
+        const char first = *targets[0].toRawUTF8();
+        int written = 0;
+
+        for (int i = text.indexOfChar (0, text.size, first); i != -1; i = text.indexOfChar (i, text.size, first))
         {
-            --i;
+            int matched = -1;
+
+            for (int t = 0; t < numTargets && matched == -1; ++t)
+            {
+                if (text.startsWith (i, text.size, targets[t].toRawUTF8()))
+                {
+                    matched = t;
+                }
+                else if (!isLast && beginsLike (text, i, targets[t].toRawUTF8(), false))
+                {
+                    // the rest of it hasn't come yet
+                    emit (text, written, i);
+                    return i;
+                }
+            }
+
+            if (matched == -1)
+            {
+                ++i;
+                continue;
+            }
+
+            emit (text, written, i);
+            emit (replacements[matched]);
+            written = i = i + (int) targets[matched].getNumBytesAsUTF8();
         }
 
-        index = resultStr.indexOfIgnoreCase (index + 2, "~~");
+        emit (text, written, text.size);
+        return text.size;
     }
 
-    //DBG (resultStr);
-    return resultStr;
-}
+    String targets[2], replacements[2];
+    int numTargets;
+};
 
 //=================================================================================================
-const String Md2Html::tocParse (const String& mdString)
+/** newLine instead of the "<br>" (ignore case) which is right after any html-tag */
+class Md2Html::Rewriter::BreakAfterTag : public Md2Html::Rewriter::Stage
 {
-    String resultStr (mdString);
+public:
+    explicit BreakAfterTag (Stage* nextStage) : Stage (nextStage), previous (0), charsToSkip (0) {}
+
+private:
+    const int rewrite (const TextView& text, const bool isLast) override
+    {
+        int written = 0;
 
-    if (!resultStr.contains ("[TOC]"))
-        return resultStr;
+        for (int i = 0; ; )
+        {
+            // newLine is 2 chars shorter than "<br>" and the next search has always begun
+            // 4 chars after it, so a "<br>" which is very close to the last one is kept
+            for (; charsToSkip > 0 && i < text.size; --charsToSkip)
+                i = text.skipChars (i, 1, text.size);
 
-    if (!(resultStr.contains ("# ") || resultStr.contains ("## ") || resultStr.contains ("### ")))
-        return resultStr;
+            i = text.indexOfChar (i, text.size, '<');
 
-    // escape '\[TOC]'
-    resultStr = resultStr.replace ("\\[TOC]", "_@_tocParseReplaceStr_@_");
-    
-    // get lines which include '#'s
-    StringArray lines;
-    lines.addLines (resultStr);
-    
-    for (int i = lines.size(); --i >= 0; )
-    {
-        if (lines[i].trimStart().substring (0, 1) != "#")
-            lines.remove (i);
-    }
+            if (i == -1)
+                break;
 
-    // doesn't extrct the title (h1) -- for article toc
-    // but when export a big-single html, it'll extrct all
-    lines.remove (0);
+            if (!beginsLike (text, i, "<br>", true))
+            {
+                ++i;
+                continue;
+            }
 
-    // process h1, h2 and h3
-    for (int i = lines.size(); --i >= 0; )
-    {
-        if (lines[i].substring (0, 2) == "# ")
-            lines.getReference (i) = "<a href=\"#" + lines[i].substring (2) + "\">"
-            + lines[i].substring (2) + "</a><br>";
+            if (i + 4 > text.size)
+            {
+                if (isLast)
+                    break;
 
-        else if (lines[i].substring (0, 3) == "## ")
-            lines.getReference (i) = " &emsp;&emsp;"
-            + String (CharPointer_UTF8 ("\xc2\xb7"))
-            + " <a href=\"#" + lines[i].substring (3) + "\">"
-            + lines[i].substring (3) + "</a><br>";
+                emit (text, written, i);
+                previous = (i > 0) ? text.data[i - 1] : previous;
+                return i;
+            }
 
-        else if (lines[i].substring (0, 4) == "### ")
-            lines.getReference (i) = " &emsp;&emsp;&emsp;&emsp;"
-            + String (CharPointer_UTF8 ("\xc2\xb7"))
-            + " <a href=\"#"
-            + lines[i].substring (4) + "\">"
-            + lines[i].substring (4) + "</a><br>";
+            if (((i > 0) ? text.data[i - 1] : previous) == '>')
+            {
+                emit (text, written, i);
+                emitNewLine();
+                written = i + 4;
+                charsToSkip = 2;
+            }
 
-        else
-            lines.remove (i);
+            i += 4;
+        }
+
+        emit (text, written, text.size);
+        previous = (text.size > 0) ? text.data[text.size - 1] : previous;
+        return text.size;
     }
 
-    const String tocContent ("<div class=toc>" + lines.joinIntoString (newLine) + "</div>");
-    resultStr = resultStr.replace ("[TOC]", tocContent);
-    resultStr = resultStr.replace ("_@_tocParseReplaceStr_@_", "[TOC]");
-    
-    return resultStr;
-}
+    /** the byte before the text, and the chars of it which can't begin a "<br>" */
+    char previous;
+    int charsToSkip;
+};
 
 //=================================================================================================
-const String Md2Html::processByLine (const String& mdString)
+/** Replace the <p> of cleanUp() with newLine and remove its <br> between the tags (ignore
+    case) of code or js. A start-tag without an end-tag after it is left as it is. The other
+    start-tag (if any) is tried when the first one doesn't match. */
+class Md2Html::Rewriter::BreaksInside : public Md2Html::Rewriter::Stage
 {
-    StringArray contentByLine;
-    contentByLine.addLines (mdString);
-
-    for (int i = contentByLine.size(); --i >= 0; )
+public:
+    BreaksInside (Stage* nextStage, const char* startTagText, const char* endTagText,
+                  const char* otherStartTagText = nullptr)
+        : Stage (nextStage), startTag (startTagText), endTag (endTagText), otherStartTag (otherStartTagText),
+          startTagLength ((int) strlen (startTag)), endTagLength ((int) strlen (endTag)),
+          otherStartTagLength (otherStartTag != nullptr ? (int) strlen (otherStartTag) : 0),
+          inside (false)
     {
-        String& currentLine (contentByLine.getReference (i));
+        jassert (startTag[0] == '<' && endTag[0] == '<');
+    }
 
-        // <hr>
-        if (currentLine.trimStart().substring (0, 3) == "---")
-            currentLine = "<hr>";
+private:
+    const int rewrite (const TextView& text, const bool isLast) override
+    {
+        int written = 0;
 
-        // <blockquote>
-        else if (currentLine.trimStart().substring (0, 2) == "> ")
-            currentLine = "<blockquote>" + currentLine.trimStart().substring (2) + "</blockquote>";
+        for (int i = text.indexOfChar (0, text.size, '<'); i != -1; i = text.indexOfChar (i, text.size, '<'))
+        {
+            const char* tag = inside ? endTag : startTag;
+            int tagLength = inside ? endTagLength : startTagLength;
 
-        // <h6> ~ <h1>
-        else if (currentLine.trimStart().substring (0, 7) == "###### ")
-            currentLine = "<h6>" + currentLine.trimStart().substring (7) + "</h6>";
+            if (!inside && otherStartTag != nullptr && !beginsLike (text, i, tag, true))
+            {
+                tag = otherStartTag;
+                tagLength = otherStartTagLength;
+            }
 
-        else if (currentLine.trimStart().substring (0, 6) == "##### ")
-            currentLine = "<h5>" + currentLine.trimStart().substring (6) + "</h5>";
+            if (!beginsLike (text, i, tag, true))
+            {
+                ++i;
+                continue;
+            }
 
-        else if (currentLine.trimStart().substring (0, 5) == "#### ")
-            currentLine = "<h4>" + currentLine.trimStart().substring (5) + "</h4>";
+            if (i + tagLength > text.size)
+            {
+                if (isLast)
+                    break;
 
-        // <h3> anchor
-        else if (currentLine.trimStart().substring (0, 4) == "### ")
-            currentLine = "<h3 id=\"" + currentLine.trimStart().substring (4) + "\">"
-            + currentLine.trimStart().substring (4) + "</h3>";
+                writeOut (text, written, i);
+                return i;
+            }
 
-        // <h2> anchor
-        else if (currentLine.trimStart().substring (0, 3) == "## ")
-            currentLine = "<h2 id=\"" + currentLine.trimStart().substring (3) + "\">" 
-            + currentLine.trimStart().substring (3) + "</h2>";
+            if (inside)
+            {
+                block.write (text.data + written, (size_t) (i - written));
+                emitWithoutBreaks();
+                emit (text, i, i + tagLength);
+            }
+            else
+            {
+                emit (text, written, i);
+                block.reset();
+                block.write (text.data + i, (size_t) tagLength);
+            }
 
-        // <h1> anchor
-        else if (currentLine.trimStart().substring (0, 2) == "# ")
-            currentLine = "<h1 id=\"" + currentLine.trimStart().substring (2) + "\">" 
-            + currentLine.trimStart().substring (2) + "</h1>";
+            inside = !inside;
+            written = i = i + tagLength;
+        }
 
-        // align
-        else if (currentLine.trimStart().substring (0, 4) == ">|< ")
-            currentLine = "<div align=center>" + currentLine.substring (4) + "</div>";
+        writeOut (text, written, text.size);
 
-        else if (currentLine.trimStart().substring (0, 4) == ">>> ")
-            currentLine = "<div align=right>" + currentLine.substring (4) + "</div>";
+        // no end-tag, the block stays the same
+        if (isLast && inside)
+        {
+            emit (static_cast<const char*> (block.getData()), (int) block.getDataSize());
+            inside = false;
+        }
 
-        // diagram description
-        else if (currentLine.trimStart().substring (0, 3) == "^^ ")
-            currentLine = "<h5 align=center>" + currentLine.substring (3) + "</h5></div>";
+        return text.size;
     }
 
-    return contentByLine.joinIntoString (newLine);
-}
-
-//=================================================================================================
-const String Md2Html::spaceLinkParse (const String& mdString)
-{
-    String resultStr (mdString);
-    int indexStart = resultStr.indexOfIgnoreCase (0, " http");
+    void writeOut (const TextView& text, const int start, const int end)
+    {
+        if (inside)
+            block.write (text.data + start, (size_t) (end - start));
+        else
+            emit (text, start, end);
+    }
 
-    while (indexStart != -1)
+    /** <p> to newLine, <br> to nothing */
+    void emitWithoutBreaks()
     {
-        const int indexEnd = resultStr.indexOfIgnoreCase (indexStart + 10, " ");
+        const TextView text (block.getData(), (int) block.getDataSize());
+        int written = 0;
 
-        if (indexEnd == -1)
-            break;
+        for (int i = text.indexOfChar (0, text.size, '<'); i != -1; i = text.indexOfChar (i, text.size, '<'))
+        {
+            const bool isP = text.startsWith (i, text.size, "<p>");
+
+            if (isP || text.startsWith (i, text.size, "<br>"))
+            {
+                emit (text, written, i);
 
-        const String linkAddress (resultStr.substring (indexStart + 1, indexEnd));
-        const String linkStr (" <a href=\"" + linkAddress + "\" target=\"_blank\">" + linkAddress + "</a>");
+                if (isP)
+                    emitNewLine();
 
-        //DBG (linkAddress);
-        if (!linkAddress.contains (newLine) && linkAddress.containsNonWhitespaceChars())
-            resultStr = resultStr.replaceSection (indexStart, linkAddress.length() + 1, linkStr);
+                written = i = i + (isP ? 3 : 4);
+            }
+            else
+            {
+                ++i;
+            }
+        }
 
-        indexStart = resultStr.indexOfIgnoreCase (indexStart + linkAddress.length(), " http");
+        emit (text, written, text.size);
     }
 
-    return resultStr;
-}
+    const char* const startTag;
+    const char* const endTag;
+    const char* const otherStartTag;
+    const int startTagLength, endTagLength, otherStartTagLength;
+
+    /** after a start-tag, the text from it is kept until the end-tag */
+    bool inside;
+    MemoryOutputStream block;
+};
 
 //=================================================================================================
-const String Md2Html::imageParse (const String& mdString)
+/** The passes around the code-blocks and <hr>, they are matched together:
+    - "<pre><code>\t\t\t\t" to "<pre><code>" (or "<pre><code class=hljs>", the same below)
+    - "<br>\n" and "<p>\n" which is before "<pre>" to newLine
+    - "<pre><code>" + newLine to "<pre><code>"
+    - "<hr>" + newLine and "</code></pre>" + newLine to the tag + "\n<p>"
+    - "<p><br>" to "<p>" (it was the last pass, but the escapes never touch these)
+
+    Each one is searched in what the ones above it have written, so the newLine after a tag
+    could be one of the breaks before "<pre>", the tabs could be between "<pre><code>" and its
+    newLine, and the <p> given after a tag could be followed by a <br>. */
+class Md2Html::Rewriter::CodeBlockGaps : public Md2Html::Rewriter::Stage
 {
-    /**< ![](media/xxx.jpg) */
-    String resultStr (mdString);
-    int indexStart = resultStr.indexOfIgnoreCase (0, "![");
+public:
+    explicit CodeBlockGaps (Stage* nextStage) : Stage (nextStage) {}
 
-    while (indexStart != -1)
+private:
+    const int rewrite (const TextView& text, const bool isLast) override
     {
-        // get alt content
-        const int altEnd = resultStr.indexOfIgnoreCase (indexStart + 2, "](");
-        if (altEnd == -1)            break;
-        const String altContent (resultStr.substring (indexStart + 2, altEnd));
+        int written = 0;
 
-        // get img path
-        const int imgEnd = resultStr.indexOfIgnoreCase (altEnd + 2, ")");
-        if (imgEnd == -1)            break;
-        const String imgPath (resultStr.substring (altEnd + 2, imgEnd));
+        for (int i = text.indexOfChar (0, text.size, '<'); i != -1; i = text.indexOfChar (i, text.size, '<'))
+        {
+            // the longest one is "<pre><code class=hljs>\t\t\t\t<br>\n<pre>"
+            if (!isLast && i + 36 > text.size)
+            {
+                emit (text, written, i);
+                return i;
+            }
 
-        const String imgStr ("<div align=center><img src=\"" + imgPath + "\" alt=\""
-                             + altContent + "\" />" + "</div>");
+            // all of them begin with "<b", "<p", "<h" or "</"
+            const char c = text[i + 1];
 
-        resultStr = resultStr.replaceSection (indexStart, imgEnd + 1 - indexStart, imgStr);
-        indexStart = resultStr.indexOfIgnoreCase (indexStart + imgStr.length(), "![");
-    }
+            if (c != 'b' && c != 'p' && c != 'h' && c != '/')
+            {
+                ++i;
+                continue;
+            }
 
-    return resultStr;
-}
+            const int end = rewriteAt (text, i, written);
 
-//=================================================================================================
-const String Md2Html::mdLinkParse (const String& mdString)
-{
-    // [](http://xxx.com)
-    String resultStr (mdString);
-    int linkPathStart = resultStr.indexOfIgnoreCase (0, "](");
+            if (end > i)
+                written = i = end;
+            else
+                ++i;
+        }
+
+        emit (text, written, text.size);
+        return text.size;
+    }
 
-    while (linkPathStart != -1)
+    /** return the end of what's rewritten at the index, or the index if nothing is there */
+    const int rewriteAt (const TextView& text, const int index, const int written)
     {
-        // get alt content
-        const String splitContent (resultStr.substring (0, linkPathStart));
-        const int altStart = splitContent.lastIndexOfIgnoreCase ("[");
+        const int breakLength = getBreakLength (text, index);
 
-        if (altStart == -1)
-            break;
+        if (breakLength > 0)
+        {
+            emit (text, written, index);
+            emitNewLine();
+            return index + breakLength;
+        }
+
+        const int codeTagLength = text.startsWith (index, text.size, "<pre><code>") ? 11
+                                : (text.startsWith (index, text.size, "<pre><code class=hljs>") ? 22 : 0);
 
-        if (resultStr.substring (altStart - 1, altStart) != "\\")
+        if (codeTagLength > 0)
         {
-            const String altContent (resultStr.substring (altStart + 1, linkPathStart));
+            const int tagEnd = index + codeTagLength;
+            const int afterTabs = tagEnd + (text.startsWith (tagEnd, text.size, "\t\t\t\t") ? 4 : 0);
+            const int end = afterTabs + getBreakLength (text, afterTabs);
 
-            // get link path
-            const int pathEnd = resultStr.indexOfIgnoreCase (linkPathStart + 2, ")");
+            if (end == tagEnd)
+                return index;
 
-            if (pathEnd == -1)
-                break;
+            emit (text, written, index);
+            emit (text, index, tagEnd);
+            return end;
+        }
 
-            String linkPath (resultStr.substring (linkPathStart + 2, pathEnd).trimEnd());
+        const int tagLength = text.startsWith (index, text.size, "<hr>") ? 4
+                            : (text.startsWith (index, text.size, "</code></pre>") ? 13 : 0);
 
-            // [](http://xxx.com/xxx.html -), the end ' -' will open the link in new window
-            if (linkPath.getLastCharacters (2) == " -")
-                linkPath = "\"" + linkPath.dropLastCharacters (2) + "\" target=\"_blank\"";
-            else
-                linkPath = "\"" + linkPath + "\"";
+        if (tagLength > 0)
+        {
+            const int end = index + tagLength + getBreakLength (text, index + tagLength);
 
-            const String linkStr ("<a href=" + linkPath + ">" + altContent + "</a>");
+            if (end == index + tagLength)
+                return index;
 
-            resultStr = resultStr.replaceSection (altStart, pathEnd + 1 - altStart, linkStr);
-            linkPathStart = resultStr.indexOfIgnoreCase (altStart + linkStr.length(), "](");
+            emit (text, written, index);
+            emit (text, index, index + tagLength);
+            emit ("\n<p>", 4);
+            return end + getBreakAfterP (text, end);
         }
-        else
+
+        if (text.startsWith (index, text.size, "<p>") && getBreakAfterP (text, index + 3) > 0)
         {
-            linkPathStart = resultStr.indexOfIgnoreCase (linkPathStart + 2, "](");
+            emit (text, written, index);
+            emit ("<p>", 3);
+            return index + 7;
         }
 
+        return index;
     }
 
-    return resultStr;
-}
+    /** the length of newLine, or the <br> or <p> (and its '\n') before "<pre>", otherwise 0 */
+    static const int getBreakLength (const TextView& text, const int index)
+    {
+        if (text.startsWith (index, text.size, "\r\n"))
+            return 2;
 
-//=================================================================================================
-const String Md2Html::orderedListParse (const String& mdString, const bool isOrdered)
-{
-    StringArray contentByLine;
-    contentByLine.addLines (mdString);
+        if (text.startsWith (index, text.size, "<br>\n<pre>"))
+            return 5;
+
+        if (text.startsWith (index, text.size, "<p>\n<pre>"))
+            return 4;
 
-    contentByLine.insert (0, "%%__ordered@List@Parse__%%");
-    contentByLine.add ("%%__ordered@List@Parse__%%");
+        return 0;
+    }
 
-    for (int i = 1; i < contentByLine.size() - 1; ++i)
+    /** the length of the <br> which follows a <p>, unless it's one of the breaks before "<pre>" */
+    static const int getBreakAfterP (const TextView& text, const int index)
     {
-        const String& prevLine = contentByLine.getReference (i - 1);
-        const String& nextLine = contentByLine.getReference (i + 1);
-        String& currentLine (contentByLine.getReference (i));
-        String prefix, postfix;
+        return (text.startsWith (index, text.size, "<br>") && getBreakLength (text, index) == 0) ? 4 : 0;
+    }
+};
+
+//=================================================================================================
+/** Remove the '\' of \* \~ \` \``` \# \[ \![ \[^ \], one escape after another as the passes
+    did, so a '\' removed by one could make another one, e.g. "\\!\[" to "\![" to "![". Only the
+    '\' and the chars of the escapes could be joined like this, so each run of them from a '\'
+    is kept and done on its own. */
+class Md2Html::Rewriter::Unescape : public Md2Html::Rewriter::Stage
+{
+public:
+    explicit Unescape (Stage* nextStage) : Stage (nextStage), inRun (false) {}
 
-        const String nestTag (isOrdered ? "    + " : "    - ");
-        const String nestedStart (isOrdered ? "    <ol>" : "    <ul>");
-        const String nestedEnd (isOrdered ? "    </ol>" : "    </ul>");
-        const String listTag (isOrdered ? "+ " : "- ");
-        const String listStart (isOrdered ? "<ol>" : "<ul>");
-        const String listEnd (isOrdered ? "</ol>" : "</ul>");
+private:
+    const int rewrite (const TextView& text, const bool isLast) override
+    {
+        int written = 0;
 
-        if (currentLine.substring (0, 6) == nestTag)
+        for (int i = 0; i < text.size; )
         {
-            if (prevLine.substring (0, 6) != nestTag
-                && prevLine.substring (0, 8) != nestedStart
-                && prevLine.substring (0, 8) != "    <li>")
-                prefix = nestedStart;
-            if (nextLine.substring (0, 6) != nestTag)
-                postfix = nestedEnd;
+            if (!inRun)
+            {
+                i = text.indexOfChar (i, text.size, '\\');
 
-            currentLine = prefix + "    <li>" + currentLine.fromFirstOccurrenceOf (nestTag, false, true) + "</li>" + postfix;
-        }
-        else if (currentLine.substring (0, 2) == listTag)
-        {
-            if (prevLine.substring (0, 2) != listTag
-                && prevLine.trimStart().substring (0, 4) != "<li>"
-                && prevLine.trimStart().substring (0, 4) != listStart)
-                prefix = listStart;
-            if (nextLine.substring (0, 2) != listTag
-                && nextLine.substring (0, 6) != nestTag)
-                postfix = listEnd;
+                if (i == -1)
+                    break;
+
+                emit (text, written, i);
+                run.setSize (0);
+                inRun = true;
+            }
 
-            currentLine = prefix + "<li>" + currentLine.fromFirstOccurrenceOf (listTag, false, true) + "</li>" + postfix;
+            const int runEnd = getRunEnd (text, i);
+            run.append (text.data + i, (size_t) (runEnd - i));
+            written = i = runEnd;
+
+            if (runEnd < text.size)
+                emitRun();
         }
 
-        if ((currentLine.substring (0, 8) == "    <li>"
-             || currentLine.substring (0, 8) == nestedStart)
-            && currentLine.getLastCharacters (5) == listEnd
-            && nextLine.substring (0, 2) != listTag)
+        if (inRun)
+        {
+            if (isLast)
+                emitRun();
+        }
+        else
         {
-            currentLine += listEnd;
+            emit (text, written, text.size);
         }
+
+        return text.size;
     }
 
-    contentByLine.removeString ("%%__ordered@List@Parse__%%");
-    return contentByLine.joinIntoString (newLine);
-}
+    /** the end of the '\' and the chars of the escapes */
+    static const int getRunEnd (const TextView& text, int index)
+    {
+        while (index < text.size && text.data[index] != 0 && strchr ("\\*~`#[!^]", text.data[index]) != nullptr)
+            ++index;
 
-//=================================================================================================
-const String Md2Html::cnBracketParse (const String& mdString)
-{
-    String resultStr (mdString);
-    int indexStart = resultStr.indexOfIgnoreCase (0, CharPointer_UTF8 ("\xef\xbc\x88"));
+        return index;
+    }
 
-    while (indexStart != -1)
+    void emitRun()
     {
-        // get note content's end index
-        const int indexEnd = resultStr.indexOfIgnoreCase (indexStart + 1, CharPointer_UTF8 ("\xef\xbc\x89"));
-
-        if (indexEnd == -1)
-            break;
+        const char* const escapes[] = { "\\*", "\\~", "\\`", "\\```", "\\#", "\\[", "\\![", "\\[^", "\\]" };
 
-        // get content inside 2 brackets
-        const String content (resultStr.substring (indexStart + 1, indexEnd));
+        char* const data = static_cast<char*> (run.getData());
+        int size = (int) run.getSize();
 
-        if (content.isNotEmpty())
+        // each of them is a pass of its own, in place (the text only gets shorter)
+        for (int e = 0; e < numElementsInArray (escapes); ++e)
         {
-            const String withSpan ("<span class=cnBracket>" + content + "</span>");
-            resultStr = resultStr.replaceSection (indexStart + 1, content.length(), withSpan);
+            const TextView text (data, size);
+            const int length = (int) strlen (escapes[e]);
+            int newSize = 0;
+
+            for (int i = 0; i < size; )
+            {
+                if (text.startsWith (i, size, escapes[e]))
+                {
+                    memmove (data + newSize, data + i + 1, (size_t) length - 1);
+                    newSize += length - 1;
+                    i += length;
+                }
+                else
+                {
+                    data[newSize++] = data[i++];
+                }
+            }
+
+            size = newSize;
         }
 
-        indexStart = resultStr.indexOfIgnoreCase (indexEnd, CharPointer_UTF8 ("\xef\xbc\x88"));
+        emit (data, size);
+        inRun = false;
     }
-    
-    return resultStr;
-}
+
+    /** from a '\', it might go on in the next text */
+    bool inRun;
+    MemoryBlock run;
+};
 
 //=================================================================================================
-const String Md2Html::cleanUp (const String& mdString)
+Md2Html::Rewriter::Rewriter (OutputStream& output)
+    : position (0)
 {
-    // transform newLine to <p> and <br>
-    String resultStr (mdString.replace ("_%5x|z%!##!_", "*") // for code parse
-                      .replace (newLine + newLine, "<p>\n")
-                      .replace (newLine, "<br>\n")
-    );
-
-    // clean extra <br> when it's after any html-tag
-    int indexBr = resultStr.indexOfIgnoreCase (0, "<br>");
-
-    while (indexBr != -1)
-    {
-        if (resultStr.substring (indexBr - 1, indexBr).contains (">"))
-            resultStr = resultStr.replaceSection (indexBr, 4, newLine);
-
-        indexBr = resultStr.indexOfIgnoreCase (indexBr + 4, "<br>");
-    }
+    // from the last pass to the first one
+    Stage* stage = stages.add (new Output (output));
 
-    // clean extra <p> and <br> which is in code-block(s)
-    int indexCodeStart = resultStr.indexOfIgnoreCase (0, "<pre><code>");
+    // for escape
+    stage = stages.add (new Unescape (stage));
 
-    while (indexCodeStart != -1 && indexCodeStart + 16 <= resultStr.length())
-    {
-        const int indexCodeEnd = resultStr.indexOfIgnoreCase (indexCodeStart + 16, "</code></pre>");
+    // clean extra <br> and <p> which before <pre><code>, make the <pre><code> at the same line
+    // with the code (otherwise the vertical-gap will too wide), give it a <p> after '<hr>' and
+    // '</code></pre>', no <br> right after a <p>
+    stage = stages.add (new CodeBlockGaps (stage));
 
-        if (indexCodeEnd == -1)
-            break;
+    // clean extra <p> and <br> which is in page's js-code (inside <body/>) and code-block(s)
+    stage = stages.add (new BreaksInside (stage, "<script", "</script>"));
+    stage = stages.add (new BreaksInside (stage, "<pre><code>", "</code></pre>", "<pre><code class=hljs>"));
 
-        const String mdCode (resultStr.substring (indexCodeStart, indexCodeEnd));
-        const String codeHtml (mdCode.replace ("<p>", newLine).replace ("<br>", String()));
+    // clean extra <br> when it's after any html-tag
+    stage = stages.add (new BreakAfterTag (stage));
 
-        resultStr = resultStr.replaceSection (indexCodeStart, mdCode.length(), codeHtml);
-        indexCodeStart = resultStr.indexOfIgnoreCase (indexCodeStart + 16, "<pre><code>");
-    }
+    // transform newLine to <p> and <br>
+    stages.add (new Replace (stage, newLine + newLine, "<p>\n", newLine, "<br>\n"));
+}
 
-    // clean extra <p> and <br> which is in page's js-code (inside <body/>)
-    indexCodeStart = resultStr.indexOfIgnoreCase (0, "<script");
+Md2Html::Rewriter::~Rewriter()
+{
+}
 
-    while (indexCodeStart != -1 && indexCodeStart + 8 <= resultStr.length())
-    {
-        const int indexCodeEnd = resultStr.indexOfIgnoreCase (indexCodeStart + 8, "</script>");
+bool Md2Html::Rewriter::write (const void* data, size_t size)
+{
+    if (size == 0)
+        return true;
 
-        if (indexCodeEnd == -1)
-            break;
+    stages.getLast()->write (static_cast<const char*> (data), (int) size);
+    position += (int64) size;
 
-        const String jsCode (resultStr.substring (indexCodeStart, indexCodeEnd));
-        const String codeHtml (jsCode.replace ("<p>", newLine).replace ("<br>", String()));
+    return true;
+}
 
-        resultStr = resultStr.replaceSection (indexCodeStart, jsCode.length(), codeHtml);
-        indexCodeStart = resultStr.indexOfIgnoreCase (indexCodeStart + 17, "<script");
-    }
+void Md2Html::Rewriter::finish()
+{
+    stages.getLast()->finish();
+}
 
-    // somehow, there's this ugly thing. dont know why.
-    resultStr = resultStr.replace ("<pre><code>				", "<pre><code>");
+//=================================================================================================
+void Md2Html::mdStringToHtml (const String& mdString, OutputStream& outputStream,
+                              const Options& options, BlockCache* blockCache)
+{
+    if (mdString.isEmpty())
+        return;
 
-    // clean extra <br> and <p> which before <pre><code>
-    resultStr = resultStr.replace ("<br>\n<pre>", newLine + "<pre>")
-        .replace ("<p>\n<pre>", newLine + "<pre>");
+    // the html of the walk goes through the passes of cleanUp() into the stream at once (see the Rewriter above)
+    Parser parser (mdString, options, blockCache);
+    Rewriter rewriter (outputStream);
 
-    // make the <pre><code> at the same line with the code
-    // otherwise the vertical-gap will too wide
-    resultStr = resultStr.replace (String ("<pre><code>") + newLine, "<pre><code>");
+    parser.writeHtml (rewriter);
+    rewriter.finish();
+}
 
-    // give it a <p> after '<hr>' and '</code></pre>'
-    //resultStr = resultStr.replace (String ("</table>") + newLine, "</table><p>");
-    resultStr = resultStr.replace (String ("<hr>") + newLine, "<hr>\n<p>");
-    resultStr = resultStr.replace (String ("</code></pre>") + newLine, "</code></pre>\n<p>");
+//=================================================================================================
+const String Md2Html::cleanUp (const String& mdString)
+{
+    const TextView text (mdString);
+    MemoryOutputStream resultStr ((size_t) text.size + text.size / 8 + 256);
 
-    // for escape
-    resultStr = resultStr.replace (String ("\\*"), "*");
-    resultStr = resultStr.replace (String ("\\~"), "~");
-    resultStr = resultStr.replace (String ("\\`"), "`");
-    resultStr = resultStr.replace (String ("\\```"), "```");
-    resultStr = resultStr.replace (String ("\\#"), "#");
-    resultStr = resultStr.replace (String ("\\["), "[");
-    resultStr = resultStr.replace (String ("\\!["), "![");
-    resultStr = resultStr.replace (String ("\\[^"), "[^");
-    resultStr = resultStr.replace (String ("\\]"), "]");
-    resultStr = resultStr.replace (String ("<p><br>"), "<p>"); 
+    Rewriter rewriter (resultStr);
+    rewriter.write (text.data, (size_t) text.size);
+    rewriter.finish();
 
-    //DBG (resultStr);
-    return resultStr;
+    //DBG (resultStr.toUTF8());
+    return resultStr.toUTF8();
 }
-
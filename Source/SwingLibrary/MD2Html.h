@@ -11,89 +11,163 @@
 #ifndef MD2HTML_H_INCLUDED
 #define MD2HTML_H_INCLUDED
 
-struct Md2Html
-{
-public:
-    /** Base on the argu Markdown string, parse and return its html string. */
-    static const String mdStringToHtml (const String& mdString);
+/** Markdown to html.
 
-private:
-    //=================================================================================================
-    // call these methods must according to the below order
+    The whole document is parsed in one top-to-bottom walk: the lines are split into blocks
+    (code-block, table, heading, list, paragraph...) and the text of each block is scanned
+    once for the inline marks (emphasis, code, link, image, endnote...).
 
-    /** process table. doesn't support align MD-tag.
-        It must at least 2 rows and 2 columns.
+    Supported Markdown:
 
-        Markdown form:
+    - table. doesn't support align MD-tag. It must at least 2 rows and 2 columns.
 
     headOne | headTwo | headThree    -> at least one ' | ', how many ' | ' then the columns + 1
     ------------------------------   -> begin with and at least 6 '-' in the second line
-    row-1-1 | row-1-2 |  row-1-3     -> divide cells by ' | '. if '|'s more than the head line's, the extra will be cut off
+    row-1-1 | row-1-2 |  row-1-3     -> divide cells by ' | '
     row-2-1 |         |  row-2-3     -> empty between two ' | ' means empty cell
     row-3-1                          -> means this row only has one content-cell which at the very left cell
                                      -> end up with an empty line
-    */
-    static const String tableParse (const String& mdString);
 
-    /** process "****" (at least 6 '*') to none. call this method must before codeBlockParse() */
-    static const String identifierParse (const String& mdString);
+    - "******" (at least 6 '*') at the beginning of a line: <p>
+    - ``` [code] ```: <pre><code>...</code></pre>, the code inside it won't be parsed. The code
+      of the languages which CodeHighlighter knows is highlighted: <pre><code class=hljs>
+    - [^Note text]: endnote, all the notes will be listed at the end of the page
+    - `code`: inline code. If one "`" in a single line (paragaph), then "`" needn't to escape :)
+    - ***text***, **text**, *text*: bold and italic, bold, italic
+    - ~~text~~: highlight (instead of the traditional delete-line)
+    - [TOC]: h1, h2 and h3 anchors. the first heading (the title) won't be listed
+    - "---": <hr>, "> ": <blockquote>, "# " ~ "###### ": <h1> ~ <h6>, h1 ~ h3 have an anchor id.
+      All of these must at the beginning of a line.
+    - defined by WDTP: ">|< " center, ">>> " right, "^^ " diagram description
+      (center and <h5> font style, it could be placed under image or table)
+    - " http://xxx.com ": auto link, open in new tab/window. must start with " http" and end with " "
+    - ![alt](media/xxx.jpg): image
+    - [text](http://xxx.com -): link. the end " -" will open the link in new window
+    - "+ " ordered list, "- " unordered list, "    + " and "    - " for the nested (2 levels only)
+    - the content inside Chinese brackets will be given a <span class=cnBracket>
+    - '\' escape: \* \~ \` \# \[ \![ \[^ \]
+*/
+struct Md2Html
+{
+public:
+    /** Everything of a conversion which doesn't come from the Markdown. A conversion only
+        reads its own copy of the options (and its own BlockCache, if any), nothing global,
+        so the documents could be converted on any thread at the same time. */
+    struct Options
+    {
+        /** English labels and all the features are enabled */
+        Options();
+
+        /** The same as above, but the labels are translated by the current LocalisedStrings.
+            Call it on the thread which is allowed to use TRANS() and pass the result on. */
+        static const Options getLocalised();
+
+        const bool operator== (const Options& other) const noexcept;
+        const bool operator!= (const Options& other) const noexcept;
+
+        String endnotesTitle;               /**< "Endnote(s): ", above the list of the endnotes */
+        String highlightColour;             /**< the background of ~~text~~, "#bbdddd" */
+
+        bool tableOfContents;               /**< [TOC] */
+        bool endnotes;                      /**< [^note] */
+        bool autoLinks;                     /**< " http://xxx.com " */
+        bool chineseBrackets;               /**< <span class=cnBracket> */
+        bool highlightCode;                 /**< <pre><code class=hljs>, see CodeHighlighter */
+    };
+
+    /** A heading ("# " ~ "###### " at the beginning of a line) of the document */
+    struct Heading
+    {
+        int level;                          /**< 1 ~ 6 */
+        String text;                        /**< the Markdown after the '#'s */
+        String anchor;                      /**< the id of h1 ~ h3 in the html, empty for h4 ~ h6 */
+        int position;                       /**< the index of the line in the Markdown (chars, not bytes) */
+    };
+
+    /** Base on the argu Markdown string, parse and return its html string.
+        It uses Options::getLocalised(). */
+    static const String mdStringToHtml (const String& mdString);
 
-    /** ``` [code] ```: <pre><code>...</pre></code> */
-    static const String codeBlockParse (const String& mdString);
+    /** Parse the Markdown string and write its html to the stream as text (the same as
+        File::appendText() does). The html is written while it's being cleaned up, a few KB
+        at a time, it's never joined into one String, so the caller could write a page around
+        it piece by piece. It uses Options::getLocalised(). */
+    static void mdStringToHtml (const String& mdString, OutputStream& outputStream);
 
-    /** [^Not text]: endnote */
-    static const String endnoteParse (const String& mdString);
+    static const String imageParse (const String& mdString);  /**< ![](media/xxx.jpg) */
 
-    /** If one "`" in a single line (paragaph), then "`" needn't to escape :) */
-    static const String inlineCodeParse (const String& mdString);
+    /** The html of the blocks which have been parsed, see below */
+    class BlockCache;
 
-    static const String boldAndItalicParse (const String& mdString);     /**< ***text*** */
-    static const String boldParse (const String& mdString);     /**< **text** */
-    static const String italicParse (const String& mdString);   /**< *text* */
+    /** The same as above, with the options. The blocks which are still in the cache (if any)
+        won't be parsed again (the cache will keep the blocks of this document only). The
+        result is always the same as the one without the cache. */
+    static const String mdStringToHtml (const String& mdString, const Options& options,
+                                        BlockCache* blockCache = nullptr);
+    static void mdStringToHtml (const String& mdString, OutputStream& outputStream,
+                                const Options& options, BlockCache* blockCache = nullptr);
 
-    /** ~~text~~: change the traditional delete-line */
-    static const String highlightParse (const String& mdString);  
+    /** The headings of the document in order, e.g. an outline of it. They are collected by
+        the same walk which writes the html (the [TOC] is made of them), this one only doesn't
+        write the page. With the BlockCache of the document which is being edited, only the
+        changed blocks will be parsed again. */
+    static const Array<Heading> getHeadings (const String& mdString, const Options& options,
+                                             BlockCache* blockCache = nullptr);
 
-    /** [TOC]: process anchors. this method must called before processByLine() 
-        only 1 level deep (h2 and h3) */
-    static const String tocParse (const String& mdString);
+private:
+    /** Tools/MdBench measures the stages one by one */
+    friend class Md2HtmlBenchmark;
 
-    /** This method will process: <hr>, <blockquote>, <h1> ~ <h6>, <align>.
-        All of these Markdown-character(s) must at the first of a line.
+    /** The single-pass parser and the UTF-8 text it scans, see MD2Html.cpp */
+    class Parser;
+    struct TextView;
 
-        <hr>: "---", must at least 3 "-" and place in a single line.
-        otherwise, all of the characters after it will be replaced to "<hr>".
+    /** The passes of cleanUp() in one walk over the html, see MD2Html.cpp */
+    class Rewriter;
 
-        <blockquote>: "> "
-        <h1>: "# " will auto place in center.
+    static const String cleanUp (const String& mdString);
 
-        defined by WDTP:
-         - center: ">|< "
-         - right: ">>> "
-         - diagram description: "^^ " (center at the line and font style is <h5>)
-           it could be placed under image or table, also could use it freely
-        */
-    static const String processByLine (const String& mdString);
+};
 
-    /** http://xxx.com open in new tab/window, must start with: " http" and end with " "   */
-    static const String spaceLinkParse (const String& mdString);
+//=================================================================================================
+/** Keeps the html of the blocks (the lines up to an empty line, including it) of the last
+    converted document. A block is only reused when its text and the state it begins with
+    (the open emphasis, the endnote number...) are both the same, so editing a paragraph of
+    a long document re-parses only that paragraph when previewing it.
 
+    Use one cache for one document which will be converted again and again. It isn't
+    thread-safe. The cache is cleared when it's used with different Options.
+*/
+class Md2Html::BlockCache
+{
 public:
-    static const String imageParse (const String& mdString);  /**< ![](media/xxx.jpg) */
+    BlockCache();
+    ~BlockCache();
+
+    void clear();
 
 private:
-    //=================================================================================================
-    /** [](http://xxx.com -)  the end " -" will open the link in new window*/
-    static const String mdLinkParse (const String& mdString); 
+    friend class Md2Html::Parser;
+    struct Block;
 
-    // only support two-level nested lists. + for ordered (true), - for unordered (false)
-    static const String orderedListParse (const String& mdString, const bool isOrdered);
+    /** the key is the text of the block and the state it begins with.
+        return nullptr if it isn't in the cache, otherwise it'll be kept for this conversion */
+    Block* const find (const MemoryBlock& key) const;
+    void add (Block* newBlock);
 
-    /** process the content inside Chinese brackets, give it a <span class=cnBracket> */
-    static const String cnBracketParse (const String& mdString);
+    static const int getHash (const MemoryBlock& key) noexcept;
 
-    static const String cleanUp (const String& mdString);
+    /** drop the blocks which weren't used by the last conversion */
+    void removeUnused();
+
+    OwnedArray<Block> blocks;
+    HashMap<int, Block*> blocksByHash;
+    int conversion;
+
+    // the blocks were parsed with these
+    Options options;
 
+    JUCE_DECLARE_NON_COPYABLE (BlockCache)
 };
 
 
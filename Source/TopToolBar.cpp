@@ -582,7 +582,10 @@ void TopToolBar::generateHtmlFiles (ValueTree tree)
 //=================================================================================================
 void TopToolBar::generateHtmlsIfNeeded()
 {
+    FileTreeContainer::applyProjectCaches();
     generateHtmlFilesIfNeeded (fileTreeContainer->projectTree);
+    HtmlProcessor::minifyAddInFiles();
+    GzipProcessor::updateSite();
     FileTreeContainer::saveProject();
 
     SHOW_MESSAGE (TRANS ("All changed items regenerate successful!"));
@@ -611,6 +614,8 @@ void TopToolBar::generateHtmlFilesIfNeeded (ValueTree tree)
 void TopToolBar::run()
 {
     generateHtmlFiles (FileTreeContainer::projectTree);
+    HtmlProcessor::minifyAddInFiles();
+    GzipProcessor::updateSite();
 
     accumulator = 0;
     progressValue = 0.999;
@@ -810,7 +815,7 @@ void TopToolBar::packProject()
         if (addFiles[m].getFileName() != "desktop.ini" 
             && themeFiles[m].getFileName() != ".DS_Store")
         {
-            builder.addFile (addFiles[m], 9, addStr + File::separatorString
+            builder.addFile (HtmlProcessor::getAddInSource (addFiles[m]), 9, addStr + File::separatorString
                              + addFiles[m].getFileName());
         }
     }
@@ -876,7 +881,8 @@ void TopToolBar::exportCurrentTpls()
     {
         // here need check if include some OS system-file
         if (addFiles[i].getFileName() != "desktop.ini" && themeFiles[i].getFileName() != ".DS_Store")
-            builder.addFile (addFiles[i], 9, addStr + File::separatorString + addFiles[i].getFileName());
+            builder.addFile (HtmlProcessor::getAddInSource (addFiles[i]), 9,
+                             addStr + File::separatorString + addFiles[i].getFileName());
     }
 
     // write to zip file
@@ -15,12 +15,17 @@
 #include "SwingLibrary/SwingUtilities.h"
 #include "SwingLibrary/SwingLookAndFeel.h"
 #include "SwingLibrary/MD2Html.h"
+#include "SwingLibrary/HtmlMinifier.h"
 #include "MainComponent.h"
 #include "TopToolBar.h"
 #include "MarkdownEditor.h"
 #include "EditAndPreview.h"
 #include "SetupPanel.h"
+#include "HtmlTemplate.h"
 #include "HtmlProcessor.h"
+#include "MediaProcessor.h"
+#include "GzipProcessor.h"
+#include "ProjectNodeTable.h"
 #include "FileTreeContainer.h"
 #include "DocTreeViewItem.h"
 #include "ReplaceComponent.h"
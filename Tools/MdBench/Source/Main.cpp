@@ -0,0 +1,644 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 16 Oct 2026 4:50:48pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include <iostream>
+
+// the stages (the Parser, the Rewriter...) are classes of MD2Html.cpp, so it's built as a part of this file
+#include "../../../Source/SwingLibrary/MD2Html.cpp"
+
+/** Md2Html benchmark.
+
+    Feeds the synthetic corpus (and the real Markdown files/dirs which given by --corpus)
+    of 1 KB ~ 10 MB through each stage of Md2Html and the whole mdStringToHtml(), then
+    reports the throughput (MB/s), the allocations (operator new) per run and the input size
+    which has the lowest throughput of every stage.
+
+    Usage: mdbench [--corpus fileOrDir]... [--max-size bytes] [--min-time ms] [--json file|-]
+           mdbench --adversarial [--adversarial-size bytes] [--max-ratio x] [--min-time ms] [--json file|-]
+           mdbench --check-stream [--corpus fileOrDir]...
+
+    The json (--json) is for diffing the results between releases.
+
+    --adversarial feeds the documents which are full of unmatched or tricky marks (the kind
+    of input that used to make the converter rescan the text at every mark) through every stage
+    and compares the time per byte with the plain text's. It fails (exit code 2) if any stage
+    is more than --max-ratio (default 30) times slower than the plain text, which means the
+    converter isn't linear on that input any more.
+
+    --check-stream converts the synthetic corpus, the adversarial documents and the --corpus
+    into a stream, and passes the parsed html to the passes of cleanUp() in pieces of many
+    sizes. It fails (exit code 2) if any of them isn't byte for byte the same as the String
+    which mdStringToHtml() returns, i.e. where a piece ends must never change the html.
+*/
+
+//=================================================================================================
+// count every operator new of this process
+static Atomic<int64> numAllocations;
+
+void* operator new (size_t size)
+{
+    ++numAllocations;
+
+    if (void* p = std::malloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete (void* p) noexcept
+{
+    std::free (p);
+}
+
+//=================================================================================================
+class Md2HtmlBenchmark
+{
+public:
+    enum Stage { parseStage = 0, cleanUpStage, imageParseStage, wholeStage, numStages };
+
+    Md2HtmlBenchmark (const int64 maxSize_, const double minTimeMs_)
+        : maxSize (maxSize_), minTimeMs (minTimeMs_)
+    {
+    }
+
+    /** the size ladder of the inputs: 1 KB, 4 KB, 16 KB ... up to maxSize */
+    const Array<int64> getInputSizes() const
+    {
+        Array<int64> sizes;
+
+        for (int64 size = 1024; size < maxSize; size *= 4)
+            sizes.add (size);
+
+        sizes.add (maxSize);
+        return sizes;
+    }
+
+    void run (const String& corpusName, const String& corpus)
+    {
+        const Array<int64> sizes (getInputSizes());
+
+        for (int i = 0; i < sizes.size(); ++i)
+        {
+            const String input (getPrefix (corpus, sizes[i]));
+            const String parsed (runStage (parseStage, input));
+
+            for (int stage = 0; stage < numStages; ++stage)
+                results.add (measure ((Stage) stage, corpusName, stage == cleanUpStage ? parsed : input));
+        }
+    }
+
+    /** return false if any stage of any adversarial document is too slow */
+    const bool runAdversarial (const int64 size, const double maxRatio)
+    {
+        const StringPairArray documents (getAdversarialDocuments());
+        Array<Result> plainResults;
+        bool passed = true;
+
+        for (int i = 0; i < documents.size(); ++i)
+        {
+            const String input (repeatToSize (documents.getAllValues()[i], size));
+            const String parsed (runStage (parseStage, input));
+
+            for (int stage = 0; stage < numStages; ++stage)
+            {
+                Result r (measure ((Stage) stage, documents.getAllKeys()[i], stage == cleanUpStage ? parsed : input));
+
+                // the first document is the plain text
+                if (i == 0)
+                    plainResults.add (r);
+
+                r.slowdown = plainResults[stage].mbPerSecond / jmax (r.mbPerSecond, 0.000001);
+                r.passed = r.slowdown <= maxRatio;
+                passed = passed && r.passed;
+
+                adversarialResults.add (r);
+            }
+        }
+
+        return passed;
+    }
+
+    /** return false if the streamed html of any document isn't the same as its String */
+    static const bool checkStream (const String& corpusName, const String& input)
+    {
+        const String expected (Md2Html::mdStringToHtml (input, Md2Html::Options()));
+        bool passed = true;
+
+        {
+            MemoryOutputStream streamed;
+            Md2Html::mdStringToHtml (input, streamed, Md2Html::Options());
+            passed = reportMismatch (corpusName, "stream", expected, streamed) && passed;
+        }
+
+        // the same html is cut at every kind of place: inside the patterns of the passes,
+        // just before and after the longest one and around the buffer size of a pass
+        Md2Html::Parser parser (input, Md2Html::Options());
+        const String parsed (parser.toHtml());
+        const char* const data = parsed.toRawUTF8();
+        const int numBytes = (int) parsed.getNumBytesAsUTF8();
+        const int pieceSizes[] = { 1, 2, 3, 5, 7, 11, 47, 48, 49, 97, 4095, 4096, 4097, 0 };
+
+        for (int i = 0; i < numElementsInArray (pieceSizes); ++i)
+        {
+            Random random (i);
+            MemoryOutputStream split;
+
+            {
+                Md2Html::Rewriter rewriter (split);
+
+                // 0: random sizes
+                for (int start = 0; start < numBytes; )
+                {
+                    const int size = jmin (numBytes - start, pieceSizes[i] > 0 ? pieceSizes[i]
+                                                                                : random.nextInt (200) + 1);
+                    rewriter.write (data + start, (size_t) size);
+                    start += size;
+                }
+
+                rewriter.finish();
+            }
+
+            const String name (pieceSizes[i] > 0 ? String (pieceSizes[i]) + " bytes" : String ("random"));
+            passed = reportMismatch (corpusName, "pieces of " + name, expected, split) && passed;
+        }
+
+        return passed;
+    }
+
+    /** name and the unit of the document which will be repeated */
+    static const StringPairArray getAdversarialDocuments()
+    {
+        StringPairArray documents;
+        documents.set ("plain", "plain text without any marks at all, only words and spaces." + String (newLine));
+        documents.set ("unmatched-italic", "*a ");
+        documents.set ("unmatched-bold", "**a ");
+        documents.set ("unmatched-highlight", "~~a ");
+        documents.set ("unmatched-code", "`a ");
+        documents.set ("escaped-code", "\\`a `b ");
+        documents.set ("unclosed-fence", "```a ");
+        documents.set ("tiny-code-blocks", "```a```" + String (newLine));
+        documents.set ("unclosed-endnote", "[^a ");
+        documents.set ("endnote-with-link", "[^a](b ");
+        documents.set ("unclosed-link", "[a ");
+        documents.set ("link-without-path-end", "[a](b ");
+        documents.set ("images-in-link", "[![a](b) ");
+        documents.set ("unclosed-image", "![a ");
+        documents.set ("image-without-path-end", "![a](b ");
+        documents.set ("unclosed-bracket", String (CharPointer_UTF8 ("\xef\xbc\x88")) + "a ");
+        documents.set ("space-links", " http://www.underwaysoft.com/a");
+        documents.set ("tags", "<b>x</b>" + String (newLine));
+        documents.set ("code-tags", "<pre><code>a");
+        documents.set ("script-tags", "<script>x" + String (newLine) + newLine);
+        documents.set ("headings-and-toc", "# a" + String (newLine) + "[TOC]" + newLine);
+        documents.set ("nested-lists", "+ a" + String (newLine) + "    - b" + newLine);
+        documents.set ("tables", "a | b" + String (newLine) + "------" + newLine + "c | d" + newLine);
+
+        return documents;
+    }
+
+    //=============================================================================================
+    static const String getStageName (const int stage)
+    {
+        switch (stage)
+        {
+            case parseStage:        return "parse";
+            case cleanUpStage:      return "cleanUp";
+            case imageParseStage:   return "imageParse";
+            default:                return "mdStringToHtml";
+        }
+    }
+
+    static const String runStage (const int stage, const String& input)
+    {
+        switch (stage)
+        {
+            case parseStage:        { Md2Html::Parser parser (input, Md2Html::Options()); return parser.toHtml(); }
+            case cleanUpStage:      return Md2Html::cleanUp (input);
+            case imageParseStage:   return Md2Html::imageParse (input);
+            default:                return Md2Html::mdStringToHtml (input, Md2Html::Options());
+        }
+    }
+
+    /** Markdown which uses all the syntax that Md2Html supports */
+    static const String createSyntheticCorpus (const int64 numBytes)
+    {
+        Random random (20170225);
+        MemoryOutputStream doc ((size_t) numBytes + 4096);
+        int section = 0;
+        int note = 0;
+
+        doc << "# WDTP Benchmark" << newLine << newLine << "[TOC]" << newLine << newLine;
+
+        while ((int64) doc.getDataSize() < numBytes)
+        {
+            switch (random.nextInt (8))
+            {
+                case 0:
+                    doc << "## Section " << ++section << newLine;
+                    break;
+
+                case 1:
+                    doc << "Some **bold**, *italic*, ***both*** and ~~highlight~~ text, `inline <code>` "
+                        << "and a [link](http://www.underwaysoft.com/index.html -) or http://www.underwaysoft.com "
+                        << "in the middle.[^note " << ++note << "]" << newLine
+                        << String (CharPointer_UTF8 ("\xe4\xb8\xad\xe6\x96\x87\xef\xbc\x88\xe6\x8b\xac"
+                                                     "\xe5\x8f\xb7\xef\xbc\x89\xe5\x86\x85\xe5\xae\xb9\xe3\x80\x82"))
+                        << newLine;
+                    break;
+
+                case 2:
+                    doc << "+ first item" << newLine << "+ second item with *emphasis*" << newLine
+                        << "    + nested item" << newLine << "    - nested unordered" << newLine
+                        << "- unordered item" << newLine;
+                    break;
+
+                case 3:
+                    doc << "Head One | Head Two | Head Three" << newLine << "--------------------" << newLine
+                        << "cell 1 | **cell 2** | `cell 3`" << newLine << "cell 4 |  | cell 6" << newLine;
+                    break;
+
+                case 4:
+                    doc << "```cpp" << newLine << "for (int i = 0; i < n; ++i)" << newLine
+                        << "    sum += *p++;  // <- not parsed" << newLine << "```" << newLine;
+                    break;
+
+                case 5:
+                    doc << "![Diagram " << section << "](media/diagram-" << section << ".jpg)" << newLine
+                        << "^^ Diagram " << section << newLine;
+                    break;
+
+                case 6:
+                    doc << "> a quote with \\*escaped\\* marks" << newLine << "---" << newLine
+                        << ">|< centered" << newLine << ">>> right" << newLine;
+                    break;
+
+                default:
+                    doc << "A plain paragraph which has more than one line," << newLine
+                        << "the lines are joined by <br> and the empty line after it makes a <p>." << newLine;
+                    break;
+            }
+
+            doc << newLine;
+        }
+
+        return doc.toUTF8();
+    }
+
+    /** all the .md files (a dir will be searched recursively) */
+    static const String loadCorpus (const StringArray& paths)
+    {
+        MemoryOutputStream corpus;
+
+        for (int i = 0; i < paths.size(); ++i)
+        {
+            const File f (File::getCurrentWorkingDirectory().getChildFile (paths[i]));
+            Array<File> files;
+
+            if (f.isDirectory())
+                f.findChildFiles (files, File::findFiles, true, "*.md");
+            else if (f.existsAsFile())
+                files.add (f);
+
+            files.sort();
+
+            for (int j = 0; j < files.size(); ++j)
+                corpus << files[j].loadFileAsString() << newLine << newLine;
+        }
+
+        return corpus.toUTF8();
+    }
+
+    //=============================================================================================
+    void printTable() const
+    {
+        std::cout << String ("stage").paddedRight (' ', 16) << String ("corpus").paddedRight (' ', 12)
+                  << String ("bytes").paddedLeft (' ', 10) << String ("MB/s").paddedLeft (' ', 10)
+                  << String ("allocs/run").paddedLeft (' ', 12) << std::endl;
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result& r (results.getReference (i));
+
+            std::cout << r.stage.paddedRight (' ', 16) << r.corpus.paddedRight (' ', 12)
+                      << String (r.inputBytes).paddedLeft (' ', 10)
+                      << String (r.mbPerSecond, 2).paddedLeft (' ', 10)
+                      << String (r.allocationsPerRun, 1).paddedLeft (' ', 12) << std::endl;
+        }
+
+        std::cout << std::endl << "worst case:" << std::endl;
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result& r (results.getReference (i));
+
+            if (isWorstCase (i))
+                std::cout << r.stage.paddedRight (' ', 16) << r.corpus.paddedRight (' ', 12)
+                          << String (r.inputBytes).paddedLeft (' ', 10)
+                          << String (r.mbPerSecond, 2).paddedLeft (' ', 10) << std::endl;
+        }
+    }
+
+    void printAdversarialTable() const
+    {
+        std::cout << String ("document").paddedRight (' ', 24) << String ("stage").paddedRight (' ', 16)
+                  << String ("MB/s").paddedLeft (' ', 10) << String ("x plain").paddedLeft (' ', 10) << std::endl;
+
+        for (int i = 0; i < adversarialResults.size(); ++i)
+        {
+            const Result& r (adversarialResults.getReference (i));
+
+            std::cout << r.corpus.paddedRight (' ', 24) << r.stage.paddedRight (' ', 16)
+                      << String (r.mbPerSecond, 2).paddedLeft (' ', 10)
+                      << String (r.slowdown, 2).paddedLeft (' ', 10)
+                      << (r.passed ? "" : "  FAILED") << std::endl;
+        }
+    }
+
+    const String toJson() const
+    {
+        Array<var> resultList, worstList, adversarialList;
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result& r (results.getReference (i));
+
+            DynamicObject::Ptr obj (new DynamicObject());
+            obj->setProperty ("stage", r.stage);
+            obj->setProperty ("corpus", r.corpus);
+            obj->setProperty ("inputBytes", r.inputBytes);
+            obj->setProperty ("outputBytes", r.outputBytes);
+            obj->setProperty ("runs", r.runs);
+            obj->setProperty ("mbPerSecond", r.mbPerSecond);
+            obj->setProperty ("allocationsPerRun", r.allocationsPerRun);
+            resultList.add (var (obj));
+
+            if (isWorstCase (i))
+            {
+                DynamicObject::Ptr worst (new DynamicObject());
+                worst->setProperty ("stage", r.stage);
+                worst->setProperty ("corpus", r.corpus);
+                worst->setProperty ("inputBytes", r.inputBytes);
+                worst->setProperty ("mbPerSecond", r.mbPerSecond);
+                worstList.add (var (worst));
+            }
+        }
+
+        for (int i = 0; i < adversarialResults.size(); ++i)
+        {
+            const Result& r (adversarialResults.getReference (i));
+
+            DynamicObject::Ptr obj (new DynamicObject());
+            obj->setProperty ("document", r.corpus);
+            obj->setProperty ("stage", r.stage);
+            obj->setProperty ("inputBytes", r.inputBytes);
+            obj->setProperty ("mbPerSecond", r.mbPerSecond);
+            obj->setProperty ("slowdown", r.slowdown);
+            obj->setProperty ("passed", r.passed);
+            adversarialList.add (var (obj));
+        }
+
+        DynamicObject::Ptr root (new DynamicObject());
+        root->setProperty ("format", "wdtp-mdbench-1");
+        root->setProperty ("maxSize", maxSize);
+        root->setProperty ("minTimeMs", minTimeMs);
+        root->setProperty ("results", resultList);
+        root->setProperty ("worstCase", worstList);
+        root->setProperty ("adversarial", adversarialList);
+
+        return JSON::toString (var (root));
+    }
+
+private:
+    struct Result
+    {
+        Result() : inputBytes (0), outputBytes (0), runs (0), mbPerSecond (0.0), allocationsPerRun (0.0),
+                   slowdown (0.0), passed (true)
+        {
+        }
+
+        String stage, corpus;
+        int64 inputBytes, outputBytes;
+        int runs;
+        double mbPerSecond, allocationsPerRun;
+
+        // adversarial only: how many times slower than the plain text per byte
+        double slowdown;
+        bool passed;
+    };
+
+    //=============================================================================================
+    /** run the stage again and again until minTimeMs passed */
+    const Result measure (const Stage stage, const String& corpusName, const String& input) const
+    {
+        const int64 allocationsBefore = numAllocations.get();
+        const double start = Time::getMillisecondCounterHiRes();
+        double elapsedMs = 0.0;
+        int64 outputBytes = 0;
+        int runs = 0;
+
+        do
+        {
+            outputBytes = (int64) runStage (stage, input).getNumBytesAsUTF8();
+            elapsedMs = Time::getMillisecondCounterHiRes() - start;
+            ++runs;
+
+        } while (elapsedMs < minTimeMs);
+
+        Result r;
+        r.stage = getStageName (stage);
+        r.corpus = corpusName;
+        r.inputBytes = (int64) input.getNumBytesAsUTF8();
+        r.outputBytes = outputBytes;
+        r.runs = runs;
+        r.mbPerSecond = (r.inputBytes * runs) / (1024.0 * 1024.0) / (jmax (elapsedMs, 0.001) / 1000.0);
+        r.allocationsPerRun = (numAllocations.get() - allocationsBefore) / (double) runs;
+
+        return r;
+    }
+
+    /** whether the result has the lowest MB/s of its stage and corpus */
+    const bool isWorstCase (const int index) const
+    {
+        const Result& r (results.getReference (index));
+
+        for (int i = 0; i < results.size(); ++i)
+        {
+            const Result& other (results.getReference (i));
+
+            if (other.stage == r.stage && other.corpus == r.corpus
+                && (other.mbPerSecond < r.mbPerSecond || (other.mbPerSecond == r.mbPerSecond && i < index)))
+                return false;
+        }
+
+        return true;
+    }
+
+    /** print where the result begins to differ, return false if it does */
+    static const bool reportMismatch (const String& corpusName, const String& how,
+                                      const String& expected, const MemoryOutputStream& result)
+    {
+        const char* const a = expected.toRawUTF8();
+        const char* const b = static_cast<const char*> (result.getData());
+        const size_t sizeA = expected.getNumBytesAsUTF8();
+        const size_t sizeB = result.getDataSize();
+
+        size_t index = 0;
+
+        while (index < sizeA && index < sizeB && a[index] == b[index])
+            ++index;
+
+        if (index == sizeA && index == sizeB)
+            return true;
+
+        std::cout << corpusName.paddedRight (' ', 24) << how.paddedRight (' ', 24)
+                  << "FAILED at byte " << (int64) index << " of " << (int64) sizeA << std::endl;
+        return false;
+    }
+
+    static const String repeatToSize (const String& unit, const int64 numBytes)
+    {
+        MemoryOutputStream text ((size_t) numBytes + (size_t) unit.getNumBytesAsUTF8());
+
+        while ((int64) text.getDataSize() < numBytes)
+            text << unit;
+
+        return text.toUTF8();
+    }
+
+    /** the corpus is repeated if it's shorter than the size, and cut at a line break */
+    static const String getPrefix (const String& corpus, const int64 numBytes)
+    {
+        MemoryOutputStream text ((size_t) numBytes + 1);
+
+        while ((int64) text.getDataSize() < numBytes && corpus.isNotEmpty())
+            text << corpus;
+
+        const char* const data = static_cast<const char*> (text.getData());
+        int64 end = jmin (numBytes, (int64) text.getDataSize());
+
+        while (end > 0 && data[end - 1] != '\n')
+            --end;
+
+        return String::fromUTF8 (data, (int) (end > 0 ? end : jmin (numBytes, (int64) text.getDataSize())));
+    }
+
+    //=============================================================================================
+    const int64 maxSize;
+    const double minTimeMs;
+    Array<Result> results, adversarialResults;
+
+    JUCE_DECLARE_NON_COPYABLE (Md2HtmlBenchmark)
+};
+
+//=================================================================================================
+int main (int argc, char* argv[])
+{
+    StringArray corpusPaths;
+    String jsonPath;
+    int64 maxSize = 10 * 1024 * 1024;
+    int64 adversarialSize = 1024 * 1024;
+    double minTimeMs = 200.0;
+    double maxRatio = 30.0;
+    bool adversarial = false;
+    bool checkStream = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg (CharPointer_UTF8 (argv[i]));
+        const String value (i + 1 < argc ? String (CharPointer_UTF8 (argv[i + 1])) : String());
+
+        if (arg == "--corpus" && value.isNotEmpty())         { corpusPaths.add (value); ++i; }
+        else if (arg == "--max-size" && value.isNotEmpty())  { maxSize = jmax ((int64) 1024, value.getLargeIntValue()); ++i; }
+        else if (arg == "--min-time" && value.isNotEmpty())  { minTimeMs = jmax (0.0, value.getDoubleValue()); ++i; }
+        else if (arg == "--json" && value.isNotEmpty())      { jsonPath = value; ++i; }
+        else if (arg == "--adversarial")                     { adversarial = true; }
+        else if (arg == "--check-stream")                    { checkStream = true; }
+        else if (arg == "--adversarial-size" && value.isNotEmpty())  { adversarialSize = jmax ((int64) 1024, value.getLargeIntValue()); ++i; }
+        else if (arg == "--max-ratio" && value.isNotEmpty())         { maxRatio = jmax (1.0, value.getDoubleValue()); ++i; }
+        else
+        {
+            std::cout << "Usage: mdbench [--corpus fileOrDir]... [--max-size bytes] [--min-time ms] [--json file|-]"
+                      << std::endl
+                      << "       mdbench --adversarial [--adversarial-size bytes] [--max-ratio x] [--min-time ms] [--json file|-]"
+                      << std::endl
+                      << "       mdbench --check-stream [--corpus fileOrDir]..." << std::endl;
+            return 1;
+        }
+    }
+
+    if (checkStream)
+    {
+        bool passed = Md2HtmlBenchmark::checkStream ("synthetic", Md2HtmlBenchmark::createSyntheticCorpus (256 * 1024));
+        const StringPairArray documents (Md2HtmlBenchmark::getAdversarialDocuments());
+
+        for (int i = 0; i < documents.size(); ++i)
+            passed = Md2HtmlBenchmark::checkStream (documents.getAllKeys()[i],
+                                                    String::repeatedString (documents.getAllValues()[i], 2000)) && passed;
+
+        if (corpusPaths.size() > 0)
+            passed = Md2HtmlBenchmark::checkStream ("real", Md2HtmlBenchmark::loadCorpus (corpusPaths)) && passed;
+
+        std::cout << (passed ? "The streamed html is the same as the String." : "The streamed html differs.")
+                  << std::endl;
+
+        return passed ? 0 : 2;
+    }
+
+    Md2HtmlBenchmark benchmark (maxSize, minTimeMs);
+
+    if (adversarial)
+    {
+        const bool passed = benchmark.runAdversarial (adversarialSize, maxRatio);
+
+        if (jsonPath == "-")
+            std::cout << benchmark.toJson() << std::endl;
+        else
+            benchmark.printAdversarialTable();
+
+        if (jsonPath.isNotEmpty() && jsonPath != "-")
+            File::getCurrentWorkingDirectory().getChildFile (jsonPath).replaceWithText (benchmark.toJson());
+
+        return passed ? 0 : 2;
+    }
+
+    benchmark.run ("synthetic", Md2HtmlBenchmark::createSyntheticCorpus (maxSize));
+
+    if (corpusPaths.size() > 0)
+    {
+        const String corpus (Md2HtmlBenchmark::loadCorpus (corpusPaths));
+
+        if (corpus.isEmpty())
+        {
+            std::cout << "No Markdown in the corpus." << std::endl;
+            return 1;
+        }
+
+        benchmark.run ("real", corpus);
+    }
+
+    if (jsonPath == "-")
+    {
+        std::cout << benchmark.toJson() << std::endl;
+    }
+    else
+    {
+        benchmark.printTable();
+
+        if (jsonPath.isNotEmpty()
+            && !File::getCurrentWorkingDirectory().getChildFile (jsonPath).replaceWithText (benchmark.toJson()))
+        {
+            std::cout << "Can't write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
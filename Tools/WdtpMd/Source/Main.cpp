@@ -0,0 +1,234 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 16 Oct 2026 6:08:50pm
+    Author:  SwingCoder
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "../../../Source/SwingLibrary/MD2Html.h"
+#include <iostream>
+
+/** wdtp-md: Markdown to html without WDTP (and without any GUI module, only juce_core).
+
+    Usage: wdtp-md [--out dir] [--jobs n] [--quiet] [--no-toc] [--no-endnotes]
+                   [--no-autolinks] [--no-highlight] [--no-brackets] fileOrDir|-...
+
+    - "xxx.md" is written beside itself as "xxx.html", or into the --out dir
+    - a dir is searched for "*.md" recursively, its tree is kept in the --out dir
+    - "-" reads the Markdown from stdin and writes the html to stdout
+
+    The files are converted on --jobs threads (the number of the CPUs by default). The time,
+    the size and the path of each file, then the total, are reported to stderr (unless --quiet),
+    so stdout only has the html of "-".
+
+    The html is the same as the content of a WDTP page (with the English labels), without the
+    template around it. The exit code is 1 if any file couldn't be read or written.
+*/
+
+//=================================================================================================
+struct Conversion
+{
+    Conversion (const File& mdFile_, const File& htmlFile_)
+        : mdFile (mdFile_), htmlFile (htmlFile_), numBytes (0), ms (0.0), succeeded (false)
+    {
+    }
+
+    const File mdFile;
+    const File htmlFile;
+    int64 numBytes;
+    double ms;
+    bool succeeded;
+};
+
+//=================================================================================================
+class ConvertJob : public ThreadPoolJob
+{
+public:
+    ConvertJob (Conversion& conversion_, const Md2Html::Options& options_)
+        : ThreadPoolJob ("Md2Html"),
+          conversion (conversion_),
+          options (options_)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        const double start = Time::getMillisecondCounterHiRes();
+
+        if (!conversion.mdFile.existsAsFile())
+            return jobHasFinished;
+
+        const String mdStr (conversion.mdFile.loadFileAsString());
+        conversion.numBytes = conversion.mdFile.getSize();
+
+        conversion.htmlFile.getParentDirectory().createDirectory();
+        conversion.htmlFile.deleteFile();
+
+        ScopedPointer<FileOutputStream> out (conversion.htmlFile.createOutputStream());
+
+        if (out != nullptr)
+        {
+            Md2Html::mdStringToHtml (mdStr, *out, options);
+            out->flush();
+            conversion.succeeded = out->getStatus().wasOk();
+        }
+
+        conversion.ms = Time::getMillisecondCounterHiRes() - start;
+        return jobHasFinished;
+    }
+
+private:
+    Conversion& conversion;
+    const Md2Html::Options options;
+
+    JUCE_DECLARE_NON_COPYABLE (ConvertJob)
+};
+
+//=================================================================================================
+static const String readStdin()
+{
+    MemoryOutputStream input;
+    char buffer[8192];
+
+    while (std::cin.read (buffer, sizeof (buffer)) || std::cin.gcount() > 0)
+        input.write (buffer, (size_t) std::cin.gcount());
+
+    return input.toUTF8();
+}
+
+static const String formatLine (const double ms, const int64 numBytes, const String& path)
+{
+    return String (ms, 2).paddedLeft (' ', 10) + " ms" + String (numBytes).paddedLeft (' ', 12)
+        + " B  " + path;
+}
+
+//=================================================================================================
+int main (int argc, char* argv[])
+{
+    StringArray inputs;
+    String outPath;
+    int numJobs = SystemStats::getNumCpus();
+    bool quiet = false;
+    Md2Html::Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg (CharPointer_UTF8 (argv[i]));
+        const String value (i + 1 < argc ? String (CharPointer_UTF8 (argv[i + 1])) : String());
+
+        if (arg == "--out" && value.isNotEmpty())          { outPath = value; ++i; }
+        else if (arg == "--jobs" && value.isNotEmpty())    { numJobs = jmax (1, value.getIntValue()); ++i; }
+        else if (arg == "--quiet")                         { quiet = true; }
+        else if (arg == "--no-toc")                        { options.tableOfContents = false; }
+        else if (arg == "--no-endnotes")                   { options.endnotes = false; }
+        else if (arg == "--no-autolinks")                  { options.autoLinks = false; }
+        else if (arg == "--no-highlight")                  { options.highlightCode = false; }
+        else if (arg == "--no-brackets")                   { options.chineseBrackets = false; }
+        else if (arg == "-" || !arg.startsWith ("--"))    { inputs.add (arg); }
+        else
+        {
+            inputs.clear();
+            break;
+        }
+    }
+
+    if (inputs.isEmpty())
+    {
+        std::cerr << "Usage: wdtp-md [--out dir] [--jobs n] [--quiet] [--no-toc] [--no-endnotes]" << std::endl
+                  << "               [--no-autolinks] [--no-highlight] [--no-brackets] fileOrDir|-..." << std::endl;
+        return 2;
+    }
+
+    const File workingDir (File::getCurrentWorkingDirectory());
+    const File outDir (outPath.isNotEmpty() ? workingDir.getChildFile (outPath) : File());
+    OwnedArray<Conversion> conversions;
+    bool failed = false;
+
+    for (int i = 0; i < inputs.size(); ++i)
+    {
+        if (inputs[i] == "-")
+        {
+            const double start = Time::getMillisecondCounterHiRes();
+            const String mdStr (readStdin());
+            const String htmlStr (Md2Html::mdStringToHtml (mdStr, options));
+
+            std::cout << htmlStr;
+            std::cout.flush();
+
+            if (!quiet)
+                std::cerr << formatLine (Time::getMillisecondCounterHiRes() - start,
+                                         (int64) mdStr.getNumBytesAsUTF8(), "-") << std::endl;
+            continue;
+        }
+
+        const File input (workingDir.getChildFile (inputs[i]));
+
+        if (input.isDirectory())
+        {
+            Array<File> mdFiles;
+            input.findChildFiles (mdFiles, File::findFiles, true, "*.md");
+            mdFiles.sort();
+
+            for (int j = 0; j < mdFiles.size(); ++j)
+            {
+                const File htmlFile (outPath.isNotEmpty()
+                                     ? outDir.getChildFile (mdFiles[j].getRelativePathFrom (input))
+                                     : mdFiles[j]);
+
+                conversions.add (new Conversion (mdFiles[j], htmlFile.withFileExtension ("html")));
+            }
+        }
+        else if (input.existsAsFile())
+        {
+            const File htmlFile (outPath.isNotEmpty() ? outDir.getChildFile (input.getFileName()) : input);
+            conversions.add (new Conversion (input, htmlFile.withFileExtension ("html")));
+        }
+        else
+        {
+            std::cerr << "Can't find " << inputs[i] << std::endl;
+            failed = true;
+        }
+    }
+
+    // each file is converted on its own, their order of finishing doesn't matter
+    const double start = Time::getMillisecondCounterHiRes();
+    int64 totalBytes = 0;
+
+    {
+        ThreadPool pool (jmin (numJobs, jmax (1, conversions.size())));
+        OwnedArray<ConvertJob> jobs;
+
+        for (int i = 0; i < conversions.size(); ++i)
+            pool.addJob (jobs.add (new ConvertJob (*conversions.getUnchecked (i), options)), false);
+
+        for (int i = 0; i < jobs.size(); ++i)
+            pool.waitForJobToFinish (jobs.getUnchecked (i), -1);
+    }
+
+    for (int i = 0; i < conversions.size(); ++i)
+    {
+        const Conversion& c = *conversions.getUnchecked (i);
+        totalBytes += c.numBytes;
+
+        if (!c.succeeded)
+        {
+            std::cerr << "Can't convert " << c.mdFile.getFullPathName() << std::endl;
+            failed = true;
+        }
+        else if (!quiet)
+        {
+            std::cerr << formatLine (c.ms, c.numBytes, c.mdFile.getRelativePathFrom (workingDir)) << std::endl;
+        }
+    }
+
+    if (!quiet && conversions.size() > 0)
+        std::cerr << formatLine (Time::getMillisecondCounterHiRes() - start, totalBytes,
+                                 "total (" + String (conversions.size()) + " files, "
+                                 + String (jmin (numJobs, conversions.size())) + " threads)") << std::endl;
+
+    return failed ? 1 : 0;
+}